@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Agent.h"
+#include "Jobs.h"
+#include "Profile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/********************* Constants **********************/
+static const char AGENT_MAGIC[8] = {'L', 'E', 'C', 'D', 'A', 'G', 'T', '1'};
+#define AGENT_SPIN_WAITS  ((int)4096)   // Checks for a request before starting to yield the CPU
+#define AGENT_YIELD_WAITS ((int)65536)  // Checks for a request before starting to sleep between them
+#define AGENT_SLEEP_NS    ((long)100000)
+#define AGENT_NAME_LENGTH ((int)256)
+#define AGENT_SCAN_MAX    ((int)128)    // Pools this small are scanned outright, the spatial hash's rings cost more when they're mostly empty
+
+/********************* Structs **********************/
+typedef struct {
+	SimWorld **worlds;
+	const PlayerInput *actions;
+	float *observations;
+	const bool *resets;     // Worlds to start a new game in instead of stepping, NULL if none are
+	const uint64_t *seeds;  // What each reset world is seeded with
+} AgentJob;
+
+/********************* Internal functions *********************/
+// Trash the ship could actually grab or that is flying about, not what it's holding or what's going into the disposal
+static bool agentTrashVisible(int index, entitytype type, void *data) {
+	TrashPool *trash = &gWorld->population.trash;
+	return index < trash->count && !trash->grabbed[index] && !trash->trashAnimation[index];
+}
+
+// Knocked out drones are harmless
+static bool agentDroneVisible(int index, entitytype type, void *data) {
+	DronePool *drones = &gWorld->population.drones;
+	return index < drones->count && !drones->dying[index];
+}
+
+// spatialQueryNearest over a whole pool, keeps the k nearest sorted by insertion
+static int agentScanNearest(const real *x, const real *y, int count, SpatialFilter filter, int k, int *nearest) {
+	const PlayerEntity *player = &gWorld->player;
+	real distances[AGENT_NEAREST_TRASH > AGENT_NEAREST_DRONES ? AGENT_NEAREST_TRASH : AGENT_NEAREST_DRONES];
+	int found = 0;
+	for (int i = 0; i < count; i++) {
+		real dx = x[i] - player->physics.x;
+		real dy = y[i] - player->physics.y;
+		real distance = (dx * dx) + (dy * dy);
+		if (distance > AGENT_OBSERVATION_RADIUS * AGENT_OBSERVATION_RADIUS || (found == k && distance >= distances[k - 1]) || !filter(i, ENTITY_TYPE_NONE, NULL))
+			continue;
+		int n = found < k ? found++ : k - 1;
+		for (; n > 0 && distances[n - 1] > distance; n--) {
+			distances[n] = distances[n - 1];
+			nearest[n] = nearest[n - 1];
+		}
+		distances[n] = distance;
+		nearest[n] = i;
+	}
+	return found;
+}
+
+// Nearest k of a pool to the ship that pass filter
+static int agentNearest(entitytype type, const real *x, const real *y, int count, SpatialFilter filter, int k, int *nearest) {
+	if (count <= AGENT_SCAN_MAX)
+		return agentScanNearest(x, y, count, filter, k, nearest);
+	return spatialQueryNearest(&gWorld->spatial, gWorld->player.physics.x, gWorld->player.physics.y, AGENT_OBSERVATION_RADIUS,
+							   SPATIAL_MASK(type), filter, NULL, k, nearest, NULL);
+}
+
+static void agentWriteEntity(float *out, real x, real y, real vx, real vy, bool flag) {
+	PlayerEntity *player = &gWorld->player;
+	out[AGENT_ENTITY_PRESENT] = 1;
+	out[AGENT_ENTITY_X] = (float)(x - player->physics.x);
+	out[AGENT_ENTITY_Y] = (float)(y - player->physics.y);
+	out[AGENT_ENTITY_VX] = (float)(vx - player->physics.velocity.x);
+	out[AGENT_ENTITY_VY] = (float)(vy - player->physics.velocity.y);
+	out[AGENT_ENTITY_FLAG] = flag ? 1 : 0;
+}
+
+// gWorld's observation, the spatial hash is from the end of the last tick like everything else in it
+static void agentWrite(float *observation) {
+	PlayerEntity *player = &gWorld->player;
+	memset(observation, 0, AGENT_OBSERVATION_SIZE * sizeof(float));
+	observation[AGENT_OBS_DONE] = player->player.hp > 0 ? 0 : 1;
+	observation[AGENT_OBS_TICKS] = (float)gWorld->ticks;
+	observation[AGENT_OBS_SCORE] = (float)gWorld->score;
+	observation[AGENT_OBS_HP] = (float)player->player.hp;
+	observation[AGENT_OBS_IFRAMES] = (float)player->player.iframes;
+	observation[AGENT_OBS_VX] = (float)player->physics.velocity.x;
+	observation[AGENT_OBS_VY] = (float)player->physics.velocity.y;
+	Vector facing = vectorFromAngle(1, player->player.direction);
+	observation[AGENT_OBS_FACING_X] = (float)facing.x;
+	observation[AGENT_OBS_FACING_Y] = (float)facing.y;
+	observation[AGENT_OBS_TURN_SPEED] = (float)player->player.dirVelocity;
+	observation[AGENT_OBS_HOLDING] = popResolve(player->player.grabbedTrash, ENTITY_TYPE_TRASH) != -1 ? 1 : 0;
+	int disposal = popResolve(gWorld->garbageDisposal, ENTITY_TYPE_GARBAGE_DISPOSAL);
+	if (disposal != -1) {
+		observation[AGENT_OBS_DISPOSAL_X] = (float)(gWorld->population.disposals.x[disposal] - player->physics.x);
+		observation[AGENT_OBS_DISPOSAL_Y] = (float)(gWorld->population.disposals.y[disposal] - player->physics.y);
+	}
+
+	int nearest[AGENT_NEAREST_TRASH > AGENT_NEAREST_DRONES ? AGENT_NEAREST_TRASH : AGENT_NEAREST_DRONES];
+	TrashPool *trash = &gWorld->population.trash;
+	int found = agentNearest(ENTITY_TYPE_TRASH, trash->x, trash->y, trash->count, agentTrashVisible, AGENT_NEAREST_TRASH, nearest);
+	for (int n = 0; n < found; n++) {
+		int i = nearest[n];
+		agentWriteEntity(&observation[AGENT_OBS_TRASH + (n * AGENT_ENTITY_SIZE)], trash->x[i], trash->y[i], trash->vx[i], trash->vy[i], trash->lethal[i]);
+	}
+	DronePool *drones = &gWorld->population.drones;
+	found = agentNearest(ENTITY_TYPE_DRONE, drones->x, drones->y, drones->count, agentDroneVisible, AGENT_NEAREST_DRONES, nearest);
+	for (int n = 0; n < found; n++) {
+		int i = nearest[n];
+		agentWriteEntity(&observation[AGENT_OBS_DRONES + (n * AGENT_ENTITY_SIZE)], drones->x[i], drones->y[i], drones->vx[i], drones->vy[i], drones->fighter[i]);
+	}
+}
+
+static SimView agentView() {
+	SimView view = {PLAYER_START_X - (GAME_WIDTH / 2), PLAYER_START_Y - (GAME_HEIGHT / 2), GAME_WIDTH, GAME_HEIGHT};
+	return view;
+}
+
+static void agentChunk(int chunk, int begin, int end, int worker, void *data) {
+	AgentJob *job = data;
+	for (int i = begin; i < end; i++) {
+		float *observation = job->observations + ((size_t)i * AGENT_OBSERVATION_SIZE);
+		if (job->resets != NULL && job->resets[i])
+			agentReset(job->worlds[i], job->seeds[i], observation);
+		else
+			agentStep(job->worlds[i], &job->actions[i], observation);
+	}
+}
+
+// Steps or resets every world in the job, the profiler is main thread only so it sits this out
+static void agentRunJob(AgentJob *job, int count) {
+	profilePause(true);
+	jobsParallelFor(count, 1, agentChunk, job);
+	profilePause(false);
+}
+
+/********************* Shared memory *********************/
+// Makes size bytes of zeroed memory other processes can map by name, returns NULL on failure
+static void *agentSharedCreate(const char *name, size_t size, void **mapping) {
+#ifdef _WIN32
+	HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name);
+	if (handle == NULL)
+		return NULL;
+	void *data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (data == NULL) {
+		CloseHandle(handle);
+		return NULL;
+	}
+	*mapping = handle;
+	return data;
+#else
+	char path[AGENT_NAME_LENGTH];
+	snprintf(path, sizeof(path), "/%s", name);
+	int file = shm_open(path, O_CREAT | O_RDWR | O_TRUNC, 0600);
+	if (file == -1)
+		return NULL;
+	void *data = ftruncate(file, size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+	close(file);
+	if (data == MAP_FAILED) {
+		shm_unlink(path);
+		return NULL;
+	}
+	*mapping = NULL;
+	return data;
+#endif
+}
+
+static void agentSharedFree(const char *name, void *data, size_t size, void *mapping) {
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(mapping);
+#else
+	char path[AGENT_NAME_LENGTH];
+	snprintf(path, sizeof(path), "/%s", name);
+	munmap(data, size);
+	shm_unlink(path);
+#endif
+}
+
+// Spins for a while since the controller usually answers quickly, then backs off so an idle server stays off the CPU
+static void agentWait(int idle) {
+	if (idle < AGENT_SPIN_WAITS)
+		return;
+#ifdef _WIN32
+	Sleep(idle < AGENT_YIELD_WAITS ? 0 : 1);
+#else
+	if (idle < AGENT_YIELD_WAITS) {
+		sched_yield();
+	} else {
+		struct timespec ts = {0, AGENT_SLEEP_NS};
+		nanosleep(&ts, NULL);
+	}
+#endif
+}
+
+static size_t agentAlign(size_t size) {
+	return (size + AGENT_SHARED_ALIGNMENT - 1) & ~(AGENT_SHARED_ALIGNMENT - 1);
+}
+
+/********************* Agent functions *********************/
+void agentReset(SimWorld *world, uint64_t seed, float *observation) {
+	SimWorld *previous = gWorld;
+	gWorld = world;
+	simEnd();
+	simStart(seed, agentView());
+	agentWrite(observation);
+	gWorld = previous;
+}
+
+bool agentStep(SimWorld *world, const PlayerInput *action, float *observation) {
+	SimWorld *previous = gWorld;
+	gWorld = world;
+	simUpdate(action);
+	agentWrite(observation);
+	gWorld = previous;
+	return world->player.player.hp > 0;
+}
+
+void agentStepMany(SimWorld **worlds, const PlayerInput *actions, float *observations, int count) {
+	AgentJob job = {worlds, actions, observations, NULL, NULL};
+	agentRunJob(&job, count);
+}
+
+void agentObserve(SimWorld *world, float *observation) {
+	SimWorld *previous = gWorld;
+	gWorld = world;
+	agentWrite(observation);
+	gWorld = previous;
+}
+
+bool agentServe(const char *name, int worlds, uint64_t seed) {
+	if (worlds <= 0)
+		return false;
+	size_t actionsOffset = agentAlign(sizeof(AgentSharedHeader));
+	size_t observationsOffset = agentAlign(actionsOffset + ((size_t)worlds * AGENT_ACTION_SIZE));
+	size_t size = observationsOffset + ((size_t)worlds * AGENT_OBSERVATION_SIZE * sizeof(float));
+	void *mapping;
+	uint8_t *memory = agentSharedCreate(name, size, &mapping);
+	if (memory == NULL)
+		return false;
+	AgentSharedHeader *header = (AgentSharedHeader*)memory;
+	uint8_t *actions = memory + actionsOffset;
+	float *observations = (float*)(memory + observationsOffset);
+
+	SimWorld **games = malloc(worlds * sizeof(SimWorld*));
+	PlayerInput *inputs = calloc(worlds, sizeof(PlayerInput));
+	bool *resets = malloc(worlds * sizeof(bool));
+	uint64_t *seeds = malloc(worlds * sizeof(uint64_t));
+	for (int i = 0; i < worlds; i++) {
+		games[i] = simWorldCreate();
+		resets[i] = true;
+		seeds[i] = seed + i;
+	}
+	AgentJob job = {games, inputs, observations, resets, seeds};
+	agentRunJob(&job, worlds);
+
+	// The magic goes in last so the controller knows everything else is ready once it sees it
+	header->worlds = worlds;
+	header->observationSize = AGENT_OBSERVATION_SIZE;
+	header->actionSize = AGENT_ACTION_SIZE;
+	header->actionsOffset = (uint32_t)actionsOffset;
+	header->observationsOffset = (uint32_t)observationsOffset;
+	atomic_thread_fence(memory_order_release);
+	memcpy(header->magic, AGENT_MAGIC, sizeof(AGENT_MAGIC));
+
+	// Actions are read straight out of the shared memory and observations written straight into it
+	uint64_t served = 0;
+	int idle = 0;
+	while (!atomic_load_explicit(&header->quit, memory_order_acquire)) {
+		uint64_t request = atomic_load_explicit(&header->request, memory_order_acquire);
+		if (request == served) {
+			// Past AGENT_YIELD_WAITS it only ever sleeps, so it stops counting there instead of overflowing
+			agentWait(idle);
+			idle += idle < AGENT_YIELD_WAITS;
+			continue;
+		}
+		for (int i = 0; i < worlds; i++) {
+			uint8_t *action = actions + ((size_t)i * AGENT_ACTION_SIZE);
+			inputs[i].left = action[AGENT_ACTION_LEFT] != 0;
+			inputs[i].right = action[AGENT_ACTION_RIGHT] != 0;
+			inputs[i].thrust = action[AGENT_ACTION_THRUST] != 0;
+			inputs[i].grabPressed = action[AGENT_ACTION_GRAB_PRESSED] != 0;
+			inputs[i].grabReleased = action[AGENT_ACTION_GRAB_RELEASED] != 0;
+			resets[i] = action[AGENT_ACTION_RESET] != 0;
+			seeds[i] += resets[i] ? worlds : 0;
+			action[AGENT_ACTION_RESET] = 0;
+		}
+		agentRunJob(&job, worlds);
+		served = request;
+		atomic_store_explicit(&header->response, served, memory_order_release);
+		idle = 0;
+	}
+
+	for (int i = 0; i < worlds; i++)
+		simWorldFree(games[i]);
+	free(games);
+	free(inputs);
+	free(resets);
+	free(seeds);
+	agentSharedFree(name, memory, size, mapping);
+	return true;
+}
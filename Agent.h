@@ -0,0 +1,94 @@
+// Steps games one action at a time for controllers outside the game (scripted bots, training), what the ship
+// can see is written straight into a flat buffer the caller owns so nothing is allocated or copied per step
+#pragma once
+#include <stdatomic.h>
+#include <stdint.h>
+#include "World.h"
+
+/********************* Constants **********************/
+#define AGENT_NEAREST_TRASH       ((int)8)      // Trash slots in an observation, nearest first
+#define AGENT_NEAREST_DRONES      ((int)8)      // Drone slots in an observation, nearest first
+#define AGENT_OBSERVATION_RADIUS  ((real)2000)  // Nothing further from the ship than this is observed
+#define AGENT_SHARED_NAME         "lecd_agent"  // Default name of the shared memory agentServe creates
+#define AGENT_SHARED_ALIGNMENT    ((size_t)64)  // Actions and observations in shared memory each start on a cache line
+
+/********************* Types *********************/
+// Floats at the start of every observation, positions and velocities are relative to the ship in world pixels and pixels per tick
+typedef enum {
+	AGENT_OBS_DONE = 0,          // 1 once the player is dead, the world needs resetting
+	AGENT_OBS_TICKS = 1,         // Ticks since the game started
+	AGENT_OBS_SCORE = 2,
+	AGENT_OBS_HP = 3,
+	AGENT_OBS_IFRAMES = 4,       // Ticks left before the ship can be damaged again
+	AGENT_OBS_VX = 5,            // The ship's own velocity
+	AGENT_OBS_VY = 6,
+	AGENT_OBS_FACING_X = 7,      // Unit vector the ship is pointing along
+	AGENT_OBS_FACING_Y = 8,
+	AGENT_OBS_TURN_SPEED = 9,    // Radians per tick, positive is clockwise
+	AGENT_OBS_HOLDING = 10,      // 1 if the ship is holding trash
+	AGENT_OBS_DISPOSAL_X = 11,   // Garbage disposal, wherever it is
+	AGENT_OBS_DISPOSAL_Y = 12,
+	AGENT_OBS_PLAYER_SIZE = 13,
+} agentobs;
+
+// Each observed trash or drone is these floats, slots with nothing in them are all 0
+typedef enum {
+	AGENT_ENTITY_PRESENT = 0,
+	AGENT_ENTITY_X = 1,
+	AGENT_ENTITY_Y = 2,
+	AGENT_ENTITY_VX = 3,
+	AGENT_ENTITY_VY = 4,
+	AGENT_ENTITY_FLAG = 5,       // Trash that would knock out a drone, or a drone that's a fighter
+	AGENT_ENTITY_SIZE = 6,
+} agententity;
+
+#define AGENT_OBS_TRASH          ((int)AGENT_OBS_PLAYER_SIZE)
+#define AGENT_OBS_DRONES         ((int)(AGENT_OBS_TRASH + (AGENT_NEAREST_TRASH * AGENT_ENTITY_SIZE)))
+#define AGENT_OBSERVATION_SIZE   ((int)(AGENT_OBS_DRONES + (AGENT_NEAREST_DRONES * AGENT_ENTITY_SIZE)))
+
+// One world's controls for a step in shared memory, a byte each so any language can fill it out
+typedef enum {
+	AGENT_ACTION_LEFT = 0,
+	AGENT_ACTION_RIGHT = 1,
+	AGENT_ACTION_THRUST = 2,
+	AGENT_ACTION_GRAB_PRESSED = 3,
+	AGENT_ACTION_GRAB_RELEASED = 4,
+	AGENT_ACTION_RESET = 5,      // Start a new game instead of stepping, cleared by the server once it has
+	AGENT_ACTION_SIZE = 8,
+} agentaction;
+
+/********************* Structs **********************/
+// Start of the shared memory agentServe creates, followed by the actions then the observations for every world.
+// The controller writes the actions then bumps request, the server steps every world, writes the observations
+// then sets response to request. Setting quit stops the server
+typedef struct {
+	char magic[8];                 // "LECDAGT1"
+	uint32_t worlds;
+	uint32_t observationSize;      // Floats per observation, AGENT_OBSERVATION_SIZE
+	uint32_t actionSize;           // Bytes per action, AGENT_ACTION_SIZE
+	uint32_t actionsOffset;        // Bytes from the start of the shared memory to the actions
+	uint32_t observationsOffset;   // Bytes from the start of the shared memory to the observations
+	_Atomic uint32_t quit;
+	_Atomic uint64_t request;
+	_Atomic uint64_t response;
+	uint8_t reserved[16];
+} AgentSharedHeader;
+
+/********************* Functions *********************/
+// Starts a new game in world and writes its first observation, AGENT_OBSERVATION_SIZE floats
+void agentReset(SimWorld *world, uint64_t seed, float *observation);
+
+// Steps world one tick with action as the controls and writes what the ship sees afterwards into observation,
+// returns false once the player is dead. Nothing is allocated once the world's pools have grown to fit
+bool agentStep(SimWorld *world, const PlayerInput *action, float *observation);
+
+// agentStep for every world at once spread across every core, actions[i] drives worlds[i] and its observation goes
+// to observations + (i * AGENT_OBSERVATION_SIZE). Each world is stepped on one thread so results don't depend on thread count
+void agentStepMany(SimWorld **worlds, const PlayerInput *actions, float *observations, int count);
+
+// Writes world's observation as it is now
+void agentObserve(SimWorld *world, float *observation);
+
+// Creates shared memory called name for worlds games and steps them whenever the controller asks until it sets quit,
+// game i is seeded seed + i then by another worlds each time it's reset. Returns false if the memory couldn't be made
+bool agentServe(const char *name, int worlds, uint64_t seed);
@@ -0,0 +1,114 @@
+# Drives the worlds of a running `LECD_sim -a <worlds>` through its shared memory, see Agent.h. Actions and
+# observations are memoryviews straight onto the shared memory so nothing is copied or serialized per step,
+# numpy.frombuffer(client.observations, numpy.float32) gives an array over them with no copy either.
+#
+# Layout, all little endian:
+#   header        "LECDAGT1", u32 worlds, u32 observation floats, u32 action bytes, u32 actions offset,
+#                 u32 observations offset, u32 quit, u64 request, u64 response, 16 reserved bytes
+#   actions       action bytes per world: left, right, thrust, grab pressed, grab released, reset
+#   observations  observation floats per world
+#
+#   python AgentClient.py [steps] [name]   steps every world with random actions and prints how fast that went
+import mmap
+import os
+import random
+import struct
+import sys
+import time
+
+AGENT_MAGIC = b"LECDAGT1"
+AGENT_SHARED_NAME = "lecd_agent"
+AGENT_HEADER = struct.Struct("<8s6I")
+AGENT_REQUEST_OFFSET = 32
+AGENT_RESPONSE_OFFSET = 40
+AGENT_QUIT_OFFSET = 28
+
+AGENT_ACTION_LEFT = 0
+AGENT_ACTION_RIGHT = 1
+AGENT_ACTION_THRUST = 2
+AGENT_ACTION_GRAB_PRESSED = 3
+AGENT_ACTION_GRAB_RELEASED = 4
+AGENT_ACTION_RESET = 5
+
+AGENT_OBS_DONE = 0
+AGENT_OBS_SCORE = 2
+
+
+class AgentClient:
+	def __init__(self, name=AGENT_SHARED_NAME, timeout=10):
+		self.memory = self._map(name, AGENT_HEADER.size, timeout)
+		magic, self.worlds, self.observation_size, self.action_size, actions, observations, quit = AGENT_HEADER.unpack_from(self.memory)
+		size = observations + (self.worlds * self.observation_size * 4)
+		self.memory.close()
+		self.memory = self._map(name, size, timeout)
+		self.view = memoryview(self.memory)
+		self.actions = self.view[actions:actions + (self.worlds * self.action_size)]
+		self.observations = self.view[observations:size].cast("f")
+		self.request = struct.unpack_from("<Q", self.memory, AGENT_REQUEST_OFFSET)[0]
+
+	# Waits for the server to make the memory and fill in the header, the magic is written last
+	@staticmethod
+	def _map(name, size, timeout):
+		deadline = time.monotonic() + timeout
+		while True:
+			try:
+				if os.name == "nt":
+					memory = mmap.mmap(-1, size, tagname=name)
+				else:
+					with open("/dev/shm/" + name, "r+b") as f:
+						memory = mmap.mmap(f.fileno(), size)
+				if memory[:len(AGENT_MAGIC)] == AGENT_MAGIC:
+					return memory
+				memory.close()
+			except (OSError, ValueError):
+				pass
+			if time.monotonic() > deadline:
+				raise TimeoutError("No agent server at \"%s\"" % name)
+			time.sleep(0.01)
+
+	# Where a world's action starts in actions and its observation starts in observations
+	def action_offset(self, world):
+		return world * self.action_size
+
+	def observation_offset(self, world):
+		return world * self.observation_size
+
+	# Steps every world with whatever is in actions and waits for the observations, the server clears reset flags once they're done
+	def step(self):
+		self.request += 1
+		struct.pack_into("<Q", self.memory, AGENT_REQUEST_OFFSET, self.request)
+		# Yields while waiting so the server gets the core if they're sharing one
+		while struct.unpack_from("<Q", self.memory, AGENT_RESPONSE_OFFSET)[0] != self.request:
+			time.sleep(0)
+
+	# Any numpy arrays or memoryviews over actions or observations have to be gone first
+	def close(self, quit=True):
+		if quit:
+			struct.pack_into("<I", self.memory, AGENT_QUIT_OFFSET, 1)
+		self.actions.release()
+		self.observations.release()
+		self.view.release()
+		self.memory.close()
+
+
+if __name__ == "__main__":
+	steps = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+	client = AgentClient(sys.argv[2] if len(sys.argv) > 2 else AGENT_SHARED_NAME)
+	best = 0
+	start = time.monotonic()
+	for step in range(steps):
+		for world in range(client.worlds):
+			action = client.action_offset(world)
+			observation = client.observation_offset(world)
+			client.actions[action + AGENT_ACTION_RESET] = client.observations[observation + AGENT_OBS_DONE] != 0
+			client.actions[action + AGENT_ACTION_THRUST] = random.random() < 0.7
+			client.actions[action + AGENT_ACTION_RIGHT] = random.random() < 0.3
+			client.actions[action + AGENT_ACTION_GRAB_PRESSED] = step % 60 == 0
+			client.actions[action + AGENT_ACTION_GRAB_RELEASED] = step % 60 == 30
+		client.step()
+		for world in range(client.worlds):
+			best = max(best, client.observations[client.observation_offset(world) + AGENT_OBS_SCORE])
+	elapsed = time.monotonic() - start
+	print("{\"worlds\": %i, \"steps\": %i, \"seconds\": %f, \"world_steps_per_second\": %f, \"best_score\": %f}" %
+		  (client.worlds, steps, elapsed, (client.worlds * steps) / elapsed, best))
+	client.close()
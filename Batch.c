@@ -0,0 +1,85 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Batch.h"
+#include "World.h"
+#include "Jobs.h"
+#include "Profile.h"
+
+/********************* Structs **********************/
+typedef struct {
+	const BatchConfig *config;
+	BatchGame *games;
+} BatchJob;
+
+/********************* Internal functions *********************/
+static double batchTime() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+static int batchCompareScores(const void *a, const void *b) {
+	real x = *(const real *)a;
+	real y = *(const real *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// Every game gets a world of its own for as long as it runs, the passes inside simUpdate run inline on this thread
+static void batchGameChunk(int chunk, int begin, int end, int worker, void *data) {
+	BatchJob *job = data;
+	SimWorld *previous = gWorld;
+	for (int i = begin; i < end; i++) {
+		SimWorld *world = simWorldCreate();
+		gWorld = world;
+		simStart(job->config->seed + i, job->config->view);
+		long tick = 0;
+		for (; tick < job->config->maxTicks && world->player.player.hp > 0; tick++) {
+			PlayerInput input = simScriptedInput(tick);
+			simUpdate(&input);
+		}
+		BatchGame *game = &job->games[i];
+		game->score = world->score;
+		game->ticks = tick;
+		game->kills = world->kills;
+		game->trashDisposed = world->trashDisposed;
+		game->survived = world->player.player.hp > 0;
+		gWorld = previous;
+		simWorldFree(world);
+	}
+}
+
+/********************* Batch functions *********************/
+void batchRun(const BatchConfig *config, BatchGame *games, BatchSummary *summary) {
+	memset(summary, 0, sizeof(BatchSummary));
+	if (config->games <= 0)
+		return;
+	BatchJob job = {config, games != NULL ? games : malloc(config->games * sizeof(BatchGame))};
+
+	// The profiler is main thread only
+	profilePause(true);
+	double start = batchTime();
+	jobsParallelFor(config->games, 1, batchGameChunk, &job);
+	summary->seconds = batchTime() - start;
+	profilePause(false);
+
+	real *scores = malloc(config->games * sizeof(real));
+	summary->games = config->games;
+	for (int i = 0; i < config->games; i++) {
+		BatchGame *game = &job.games[i];
+		scores[i] = game->score;
+		summary->worldTicks += game->ticks;
+		summary->survived += game->survived ? 1 : 0;
+		summary->meanScore += game->score / config->games;
+		summary->meanTicks += (real)game->ticks / config->games;
+		summary->meanKills += (real)game->kills / config->games;
+		summary->meanTrashDisposed += (real)game->trashDisposed / config->games;
+	}
+	qsort(scores, config->games, sizeof(real), batchCompareScores);
+	summary->medianScore = scores[config->games / 2];
+	summary->p90Score = scores[(config->games * 9) / 10];
+	summary->maxScore = scores[config->games - 1];
+	free(scores);
+	if (games == NULL)
+		free(job.games);
+}
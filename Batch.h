@@ -0,0 +1,40 @@
+// Plays many independent games at once across every core with the scripted pilot, for seeing how changes
+// to the tuning constants play out over thousands of games
+#pragma once
+#include "Sim.h"
+
+/********************* Structs **********************/
+typedef struct {
+	int games;
+	long maxTicks;  // Games still going after this many ticks are stopped there
+	uint64_t seed;  // Game i is seeded with seed + i
+	SimView view;
+} BatchConfig;
+
+// How one game went
+typedef struct {
+	real score;
+	long ticks;
+	int kills;
+	int trashDisposed;
+	bool survived;  // Still alive at maxTicks
+} BatchGame;
+
+typedef struct {
+	int games;
+	long worldTicks;  // Ticks stepped over every game
+	double seconds;
+	int survived;
+	real meanScore;
+	real medianScore;
+	real p90Score;
+	real maxScore;
+	real meanTicks;
+	real meanKills;
+	real meanTrashDisposed;
+} BatchSummary;
+
+/********************* Functions *********************/
+// Plays every game through and sums them up, games gets how each one went in seed order if it isn't NULL.
+// Each game is stepped on one thread so the results are the same for any thread count
+void batchRun(const BatchConfig *config, BatchGame *games, BatchSummary *summary);
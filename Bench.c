@@ -0,0 +1,498 @@
+// Benchmarks for the simulation's hot paths, prints one JSON object with a result per scenario
+//   LECD_bench [ticks] [threads]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "World.h"
+#include "Jobs.h"
+#include "Profile.h"
+#include "Snapshot.h"
+#include "Agent.h"
+#include "Spatial.h"
+
+const int BENCH_TICKS          = 2000;
+const int BENCH_WARMUP_TICKS   = 300;
+const int BENCH_PHYSICS_COUNT  = 4096;
+const uint64_t BENCH_SEED      = 1;
+const int BENCH_SNAPSHOT_TICKS = FPS_LIMIT * 5;  // History kept by the snapshot benchmark
+const int BENCH_REWIND_TICKS   = FPS_LIMIT * 2;  // How far back it rewinds to check the world plays out the same again
+const double BENCH_SNAPSHOT_BUDGET_NS = 1000000; // Most a snapshot should take on average, 6% of a 60hz frame
+const int BENCH_AGENT_WORLDS   = 64;
+
+/********************* Allocation counting *********************/
+// With LECD_BENCH_COUNT_ALLOCATIONS the linker routes every allocator call through these
+#ifdef LECD_BENCH_COUNT_ALLOCATIONS
+long gAllocations = 0;
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+	gAllocations++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+	gAllocations++;
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	gAllocations++;
+	return __real_realloc(ptr, size);
+}
+#else
+long gAllocations = -1;
+#endif
+
+// Seconds since some arbitrary point
+double wallTime() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+/********************* Polar physics, how entities used to move *********************/
+typedef struct {
+	real magnitude;
+	real direction;
+} PolarVector;
+
+static void polarMove(real *x, real *y, PolarVector *velocity, PolarVector *acceleration) {
+	if (acceleration != NULL) {
+		// Add acceleration vector to the velocity vector then cap velocity
+		real rise = (sin(acceleration->direction) * acceleration->magnitude) + (sin(velocity->direction) * velocity->magnitude);
+		real run = (cos(acceleration->direction) * acceleration->magnitude) + (cos(velocity->direction) * velocity->magnitude);
+		velocity->direction = run == 0 ? 0 : atan2(rise, run);
+		velocity->magnitude = sqrt(pow(rise, 2) + pow(run, 2));
+		velocity->magnitude = simClamp(velocity->magnitude, -PHYSICS_BASE_TOP_SPEED, PHYSICS_BASE_TOP_SPEED);
+	}
+
+	// Apply velocity to coordinates then cap coordinates
+	*x += simCastX(velocity->magnitude, -velocity->direction);
+	*y += simCastY(velocity->magnitude, -velocity->direction);
+	*x = simClamp(*x, 0, WORLD_MAX_WIDTH);
+	*y = simClamp(*y, 0, WORLD_MAX_HEIGHT);
+}
+
+/********************* Physics benchmarks *********************/
+// Every entity accelerates towards a point then moves, like drones chasing the player
+// Every entity accelerates towards a point then moves, like drones chasing the player
+double benchPolar(real *x, real *y, int count, int ticks) {
+	PolarVector *velocity = calloc(count, sizeof(PolarVector));
+	double start = wallTime();
+	for (int tick = 0; tick < ticks; tick++) {
+		for (int i = 0; i < count; i++) {
+			PolarVector acceleration = {DRONE_BASE_ACCELERATION, (SIM_PI / 2) - simPointAngle(x[i], y[i], PLAYER_START_X, PLAYER_START_Y) - (SIM_PI / 2)};
+			polarMove(&x[i], &y[i], &velocity[i], &acceleration);
+		}
+	}
+	double elapsed = wallTime() - start;
+	free(velocity);
+	return elapsed;
+}
+
+double benchCartesian(real *x, real *y, int count, int ticks) {
+	real *vx = calloc(count, sizeof(real));
+	real *vy = calloc(count, sizeof(real));
+	double start = wallTime();
+	for (int tick = 0; tick < ticks; tick++) {
+		for (int i = 0; i < count; i++) {
+			real dx = PLAYER_START_X - x[i];
+			real dy = PLAYER_START_Y - y[i];
+			real dist = sqrt((dx * dx) + (dy * dy));
+			if (dist > 0)
+				physicsAccelerate(&vx[i], &vy[i], dx / dist * DRONE_BASE_ACCELERATION, dy / dist * DRONE_BASE_ACCELERATION);
+		}
+		physicsIntegrate(x, y, vx, vy, count);
+	}
+	double elapsed = wallTime() - start;
+	free(vx);
+	free(vy);
+	return elapsed;
+}
+
+// Positions get scattered the same way before every run so both see the same work
+void scatter(real *x, real *y, int count) {
+	RandomStream stream;
+	randomStreamSeed(&stream, 0, 0);
+	for (int i = 0; i < count; i++) {
+		x[i] = randomStreamDouble(&stream) * WORLD_MAX_WIDTH;
+		y[i] = randomStreamDouble(&stream) * WORLD_MAX_HEIGHT;
+	}
+}
+
+/********************* Scenarios *********************/
+// A scenario starts a game then gets a chance to mess with the world before every tick
+typedef struct {
+	const char *name;
+	void (*setup)(int param);
+	void (*tick)(int param);
+	int param;
+} BenchScenario;
+
+// Trash awake or asleep
+int benchTrashCount() {
+	return gWorld->population.trash.count + gWorld->population.sleepingTrash.count;
+}
+
+// Spawns trash like the game does until there are count of them
+void benchFillTrash(int count) {
+	while (benchTrashCount() < count)
+		trashStart(popSpawn(ENTITY_TYPE_TRASH, NULL));
+}
+
+// Spawns drones like the game does until count of them are alive
+void benchFillDrones(int count) {
+	gWorld->enemyMax = count;
+	while (gWorld->enemyCount < count)
+		droneStart(popSpawn(ENTITY_TYPE_DRONE, NULL));
+}
+
+void steadySetup(int param) {}
+void steadyTick(int param) {}
+
+// Trash is topped back up to param every tick
+void trashTick(int param) {
+	benchFillTrash(param);
+}
+
+// Drones spawn right away and the swarm is topped back up to param every tick
+void swarmSetup(int param) {
+	gWorld->spawnDelay = DRONE_SPAWN_DELAY;
+	benchFillDrones(param);
+}
+
+void swarmTick(int param) {
+	benchFillDrones(param);
+}
+
+// param drones around the player with param thrown trash flying through them in every direction
+void collisionsSetup(int param) {
+	swarmSetup(param);
+}
+
+// Tops trash thrown in every direction around the player back up to count
+void benchFillThrownTrash(int count) {
+	TrashPool *trash = &gWorld->population.trash;
+	while (trash->count < count) {
+		int i = popSpawn(ENTITY_TYPE_TRASH, NULL);
+		trashStart(i);
+		trash->x[i] = gWorld->player.physics.x + randomRangeReal(RANDOM_STREAM_TRASH, -DRONE_SPAWN_DISTANCE, DRONE_SPAWN_DISTANCE);
+		trash->y[i] = gWorld->player.physics.y + randomRangeReal(RANDOM_STREAM_TRASH, -DRONE_SPAWN_DISTANCE, DRONE_SPAWN_DISTANCE);
+		Vector velocity = vectorFromAngle(PLAYER_BASE_TRASH_THROW_SPEED, randomRangeReal(RANDOM_STREAM_TRASH, 0, SIM_PI * 2));
+		trash->vx[i] = velocity.x;
+		trash->vy[i] = velocity.y;
+		trash->wasThrown[i] = true;
+		trash->lethal[i] = true;
+	}
+}
+
+void collisionsTick(int param) {
+	benchFillDrones(param);
+	benchFillThrownTrash(param);
+}
+
+// param garbage disposals spread around the player with thrown trash flying between them, the cost per trash
+// shouldn't depend on how many there are
+void attractorsSetup(int param) {
+	DisposalPool *disposals = &gWorld->population.disposals;
+	while (disposals->count < param) {
+		int i = popSpawn(ENTITY_TYPE_GARBAGE_DISPOSAL, NULL);
+		garbageDisposalStart(i);
+		disposals->x[i] = gWorld->player.physics.x + randomRangeReal(RANDOM_STREAM_TRASH, -DRONE_SPAWN_DISTANCE * 2, DRONE_SPAWN_DISTANCE * 2);
+		disposals->y[i] = gWorld->player.physics.y + randomRangeReal(RANDOM_STREAM_TRASH, -DRONE_SPAWN_DISTANCE * 2, DRONE_SPAWN_DISTANCE * 2);
+	}
+}
+
+void attractorsTick(int param) {
+	benchFillThrownTrash(2000);
+}
+
+// Trash drifting all over the world is topped back up to param every tick, most of it far from the player
+void scatteredTick(int param) {
+	TrashPool *trash = &gWorld->population.trash;
+	while (benchTrashCount() < param) {
+		int i = popSpawn(ENTITY_TYPE_TRASH, NULL);
+		trashStart(i);
+		trash->x[i] = trash->lastX[i] = randomRangeReal(RANDOM_STREAM_TRASH, 0, WORLD_MAX_WIDTH);
+		trash->y[i] = trash->lastY[i] = randomRangeReal(RANDOM_STREAM_TRASH, 0, WORLD_MAX_HEIGHT);
+	}
+}
+
+// The same with every trash stepped every tick
+void noLodSetup(int param) {
+	gWorld->lod = false;
+}
+
+const BenchScenario BENCH_SCENARIOS[] = {
+	{"steady", steadySetup, steadyTick, 0},
+	{"trash_at_max", steadySetup, trashTick, TRASH_MAX},
+	{"trash_over_max", steadySetup, trashTick, TRASH_MAX * 4},
+	{"drones_50", swarmSetup, swarmTick, 50},
+	{"drones_500", swarmSetup, swarmTick, 500},
+	{"drones_2000", swarmSetup, swarmTick, 2000},
+	{"thrown_collisions", collisionsSetup, collisionsTick, 2000},
+	{"attractors_1", attractorsSetup, attractorsTick, 1},
+	{"attractors_64", attractorsSetup, attractorsTick, 64},
+	{"trash_scattered", steadySetup, scatteredTick, TRASH_MAX * 4},
+	{"trash_scattered_no_lod", noLodSetup, scatteredTick, TRASH_MAX * 4},
+};
+
+int compareDoubles(const void *a, const void *b) {
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// Runs a scenario with an invincible scripted pilot and prints its results as a JSON object
+void benchRunScenario(const BenchScenario *scenario, int ticks) {
+	SimView view = {PLAYER_START_X - (GAME_WIDTH / 2), PLAYER_START_Y - (GAME_HEIGHT / 2), GAME_WIDTH, GAME_HEIGHT};
+	double *samples = malloc(ticks * sizeof(double));
+	double entityTicks = 0;
+	long allocations = 0;
+
+	simStart(BENCH_SEED, view);
+	gWorld->lod = true;
+	gWorld->player.player.hp = 1000000000;
+	scenario->setup(scenario->param);
+	for (long tick = 0; tick < BENCH_WARMUP_TICKS + ticks; tick++) {
+		PlayerInput input = simScriptedInput(tick);
+		scenario->tick(scenario->param);
+		long allocationsBefore = gAllocations;
+		double start = wallTime();
+		simUpdate(&input);
+		double elapsed = wallTime() - start;
+
+		if (tick == BENCH_WARMUP_TICKS - 1)
+			profileReset();
+		if (tick >= BENCH_WARMUP_TICKS) {
+			samples[tick - BENCH_WARMUP_TICKS] = elapsed * 1000000000.0;
+			entityTicks += benchTrashCount() + gWorld->population.drones.count;
+			allocations += gAllocations - allocationsBefore;
+		}
+	}
+	simEnd();
+
+	double total = 0;
+	for (int i = 0; i < ticks; i++)
+		total += samples[i];
+	qsort(samples, ticks, sizeof(double), compareDoubles);
+	printf("\t\t{\"name\": \"%s\", \"ticks\": %i, \"entities\": %.1f, \"ns_per_tick\": %.1f, \"ns_per_entity\": %.2f, "
+		   "\"allocations_per_tick\": %.3f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"max_ns\": %.1f",
+		   scenario->name, ticks, entityTicks / ticks, total / ticks, entityTicks > 0 ? total / entityTicks : 0,
+		   gAllocations >= 0 ? (double)allocations / ticks : -1, samples[ticks / 2], samples[(ticks * 9) / 10],
+		   samples[(ticks * 99) / 100], samples[ticks - 1]);
+#ifdef LECD_PROFILE
+	// Where each tick's time went
+	profilezone phases[] = {PROFILE_ZONE_PLAYER, PROFILE_ZONE_ENTITIES, PROFILE_ZONE_SPATIAL, PROFILE_ZONE_COLLISIONS};
+	printf(", \"phase_ns_per_tick\": {");
+	for (int i = 0; i < sizeof(phases) / sizeof(profilezone); i++)
+		printf("%s\"%s\": %.1f", i > 0 ? ", " : "", profileZoneName(phases[i]), (profileZoneTotal(phases[i]) * 1000000000.0) / ticks);
+	printf("}");
+#endif
+	printf("}");
+	free(samples);
+}
+
+/********************* Spatial pair check *********************/
+#define BENCH_PAIR_ITEMS ((int)4)
+
+// Items overlapping with each other in every pool, sharing indices across pools
+static const real BENCH_PAIR_X[ENTITY_TYPE_MAX][BENCH_PAIR_ITEMS] = {
+	[ENTITY_TYPE_TRASH] = {110, 120, 5000, 140},
+	[ENTITY_TYPE_DRONE] = {100, 105, 130, 5000},
+};
+
+typedef struct {
+	int counts[BENCH_PAIR_ITEMS][BENCH_PAIR_ITEMS];
+} BenchPairCounts;
+
+static bool benchCountPair(int indexA, int indexB, real distance, void *data) {
+	((BenchPairCounts *)data)->counts[indexA][indexB]++;
+	return true;
+}
+
+// Whether spatialForEachPair found exactly the pairs of typeA and typeB within radius, each once
+static bool benchCheckPairs(SpatialHash *hash, entitytype typeA, entitytype typeB, real radius) {
+	BenchPairCounts found = {};
+	spatialForEachPair(hash, radius, SPATIAL_MASK(typeA), SPATIAL_MASK(typeB), benchCountPair, &found);
+	for (int a = 0; a < BENCH_PAIR_ITEMS; a++) {
+		for (int b = 0; b < BENCH_PAIR_ITEMS; b++) {
+			// Pairs within one pool can be reported either way round, they're checked once from the lower index
+			bool samePool = typeA == typeB;
+			if (samePool && a > b)
+				continue;
+			bool near = !(samePool && a == b) && fabs(BENCH_PAIR_X[typeA][a] - BENCH_PAIR_X[typeB][b]) < radius;
+			int counted = found.counts[a][b] + (samePool && a != b ? found.counts[b][a] : 0);
+			if (counted != (near ? 1 : 0))
+				return false;
+		}
+	}
+	return true;
+}
+
+// Drone i has to be paired with trash i when they touch even though they have the same index
+bool benchSpatialPairs() {
+	SpatialHash hash;
+	spatialInit(&hash);
+	for (int i = 0; i < BENCH_PAIR_ITEMS; i++) {
+		spatialInsert(&hash, i, ENTITY_TYPE_TRASH, BENCH_PAIR_X[ENTITY_TYPE_TRASH][i], 100);
+		spatialInsert(&hash, i, ENTITY_TYPE_DRONE, BENCH_PAIR_X[ENTITY_TYPE_DRONE][i], 100);
+	}
+	spatialBuild(&hash);
+	bool matches = benchCheckPairs(&hash, ENTITY_TYPE_DRONE, ENTITY_TYPE_TRASH, DRONE_TRASH_COLLISION_DISTANCE) &&
+				   benchCheckPairs(&hash, ENTITY_TYPE_TRASH, ENTITY_TYPE_TRASH, DRONE_TRASH_COLLISION_DISTANCE) &&
+				   benchCheckPairs(&hash, ENTITY_TYPE_DRONE, ENTITY_TYPE_DRONE, DRONE_TRASH_COLLISION_DISTANCE);
+	spatialFree(&hash);
+	return matches;
+}
+
+/********************* Snapshot benchmark *********************/
+// Snapshots every tick of a full world, then rewinds and checks the same ticks play out the same again, returns false if they don't
+bool benchSnapshots(int ticks) {
+	SimView view = {PLAYER_START_X - (GAME_WIDTH / 2), PLAYER_START_Y - (GAME_HEIGHT / 2), GAME_WIDTH, GAME_HEIGHT};
+	int total = BENCH_WARMUP_TICKS + ticks;
+	double *samples = malloc(ticks * sizeof(double));
+	uint64_t *hashes = malloc((total + 1) * sizeof(uint64_t));
+	double encoded = 0;
+	double raw = 0;
+	SnapshotRing ring;
+	snapshotInit(&ring, BENCH_SNAPSHOT_TICKS);
+
+	simStart(BENCH_SEED, view);
+	gWorld->lod = true;
+	gWorld->player.player.hp = 1000000000;
+	snapshotCapture(&ring);
+	for (long tick = 0; tick < total; tick++) {
+		PlayerInput input = simScriptedInput(tick);
+		trashTick(TRASH_MAX);
+		simUpdate(&input);
+		hashes[gWorld->ticks] = simHash();
+		double start = wallTime();
+		snapshotCapture(&ring);
+		double elapsed = wallTime() - start;
+		if (tick >= BENCH_WARMUP_TICKS) {
+			SnapshotFrame *frame = &ring.frames[(ring.start + ring.count - 1) % ring.capacity];
+			samples[tick - BENCH_WARMUP_TICKS] = elapsed * 1000000000.0;
+			encoded += frame->size;
+			raw += frame->rawSize;
+		}
+	}
+
+	// Put the world back then step it forwards again with the same input
+	long rewindTo = snapshotNewest(&ring) - BENCH_REWIND_TICKS;
+	rewindTo = rewindTo > snapshotOldest(&ring) ? rewindTo : snapshotOldest(&ring);
+	size_t memory = snapshotMemory(&ring);
+	double start = wallTime();
+	bool matches = snapshotRestore(&ring, rewindTo) && simHash() == hashes[rewindTo];
+	double restore = wallTime() - start;
+	for (long tick = rewindTo; matches && tick < total; tick++) {
+		PlayerInput input = simScriptedInput(tick);
+		trashTick(TRASH_MAX);
+		simUpdate(&input);
+		matches = simHash() == hashes[gWorld->ticks];
+	}
+	simEnd();
+	snapshotFree(&ring);
+
+	double captureTotal = 0;
+	for (int i = 0; i < ticks; i++)
+		captureTotal += samples[i];
+	qsort(samples, ticks, sizeof(double), compareDoubles);
+	printf("\t\"snapshots\": {\"entities\": %i, \"capture_ns_per_tick\": %.1f, \"p99_ns\": %.1f, \"budget_ns\": %.1f, "
+		   "\"within_budget\": %s, \"raw_bytes_per_tick\": %.1f, \"bytes_per_tick\": %.1f, \"history_ticks\": %i, "
+		   "\"history_bytes\": %zu, \"restore_ns\": %.1f, \"rewound_ticks\": %ld, \"rewind_matches\": %s},\n",
+		   TRASH_MAX, captureTotal / ticks, samples[(ticks * 99) / 100], BENCH_SNAPSHOT_BUDGET_NS,
+		   captureTotal / ticks <= BENCH_SNAPSHOT_BUDGET_NS ? "true" : "false", raw / ticks, encoded / ticks,
+		   BENCH_SNAPSHOT_TICKS, memory, restore * 1000000000.0, total - rewindTo, matches ? "true" : "false");
+	free(samples);
+	free(hashes);
+	return matches;
+}
+
+/********************* Agent benchmark *********************/
+// Steps a batch of worlds with observations the way a training loop would, either one after another on this thread or
+// spread across the worker pool with agentStepMany. Returns the seconds spent stepping after the warmup
+double benchAgentRun(int ticks, bool pooled, long *allocations) {
+	SimWorld **worlds = malloc(BENCH_AGENT_WORLDS * sizeof(SimWorld*));
+	PlayerInput *actions = malloc(BENCH_AGENT_WORLDS * sizeof(PlayerInput));
+	float *observations = malloc(BENCH_AGENT_WORLDS * AGENT_OBSERVATION_SIZE * sizeof(float));
+	for (int i = 0; i < BENCH_AGENT_WORLDS; i++) {
+		worlds[i] = simWorldCreate();
+		agentReset(worlds[i], BENCH_SEED + i, observations + (i * AGENT_OBSERVATION_SIZE));
+		worlds[i]->player.player.hp = 1000000000;
+	}
+
+	double elapsed = 0;
+	*allocations = 0;
+	for (long tick = 0; tick < BENCH_WARMUP_TICKS + ticks; tick++) {
+		for (int i = 0; i < BENCH_AGENT_WORLDS; i++)
+			actions[i] = simScriptedInput(tick + i);
+		long allocationsBefore = gAllocations;
+		double start = wallTime();
+		if (pooled) {
+			agentStepMany(worlds, actions, observations, BENCH_AGENT_WORLDS);
+		} else {
+			for (int i = 0; i < BENCH_AGENT_WORLDS; i++)
+				agentStep(worlds[i], &actions[i], observations + (i * AGENT_OBSERVATION_SIZE));
+		}
+		if (tick >= BENCH_WARMUP_TICKS) {
+			elapsed += wallTime() - start;
+			*allocations += gAllocations - allocationsBefore;
+		}
+	}
+	for (int i = 0; i < BENCH_AGENT_WORLDS; i++)
+		simWorldFree(worlds[i]);
+	free(worlds);
+	free(actions);
+	free(observations);
+	return elapsed;
+}
+
+// Prints how many steps a second one thread and the whole worker pool manage, the pool is what the
+// shared memory server uses so it's what counts towards a training loop's speed
+void benchAgents(int ticks) {
+	long allocations;
+	double single = benchAgentRun(ticks, false, &allocations);
+	double pooled = benchAgentRun(ticks, true, &allocations);
+	double steps = (double)BENCH_AGENT_WORLDS * ticks;
+	printf("\t\"agents\": {\"worlds\": %i, \"observation_floats\": %i, \"workers\": %i, \"ns_per_step\": %.1f, "
+		   "\"steps_per_second\": %.1f, \"one_thread_steps_per_second\": %.1f, \"allocations_per_step\": %.3f},\n",
+		   BENCH_AGENT_WORLDS, AGENT_OBSERVATION_SIZE, jobsWorkerCount(), (pooled * 1000000000.0) / steps,
+		   pooled > 0 ? steps / pooled : 0, single > 0 ? steps / single : 0, gAllocations >= 0 ? allocations / steps : -1);
+}
+
+int main(int argc, const char **argv) {
+	int ticks = argc > 1 ? atoi(argv[1]) : BENCH_TICKS;
+	ticks = ticks > 0 ? ticks : BENCH_TICKS;
+	jobsInit(argc > 2 ? atoi(argv[2]) : 0);
+
+	bool pairsMatch = benchSpatialPairs();
+	printf("{\n\t\"threads\": %i,\n\t\"spatial_pairs_match\": %s,\n\t\"scenarios\": [\n", jobsWorkerCount(), pairsMatch ? "true" : "false");
+	int scenarioCount = sizeof(BENCH_SCENARIOS) / sizeof(BenchScenario);
+	for (int i = 0; i < scenarioCount; i++) {
+		benchRunScenario(&BENCH_SCENARIOS[i], ticks);
+		printf(i < scenarioCount - 1 ? ",\n" : "\n");
+	}
+	printf("\t],\n");
+	bool rewindMatches = benchSnapshots(ticks);
+	benchAgents(ticks);
+
+	// Old polar physics against the current cartesian physics on the same workload
+	real *x = malloc(BENCH_PHYSICS_COUNT * sizeof(real));
+	real *y = malloc(BENCH_PHYSICS_COUNT * sizeof(real));
+	int physicsTicks = ticks / 4 > 0 ? ticks / 4 : 1;
+	double perEntity = 1000000000.0 / ((double)BENCH_PHYSICS_COUNT * physicsTicks);
+	scatter(x, y, BENCH_PHYSICS_COUNT);
+	double polar = benchPolar(x, y, BENCH_PHYSICS_COUNT, physicsTicks);
+	scatter(x, y, BENCH_PHYSICS_COUNT);
+	double cartesian = benchCartesian(x, y, BENCH_PHYSICS_COUNT, physicsTicks);
+	printf("\t\"physics\": {\"entities\": %i, \"polar_ns_per_entity\": %.2f, \"cartesian_ns_per_entity\": %.2f}\n}\n",
+		   BENCH_PHYSICS_COUNT, polar * perEntity, cartesian * perEntity);
+	free(x);
+	free(y);
+	jobsFree();
+	return rewindMatches && pairsMatch ? 0 : 1;
+}
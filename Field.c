@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Field.h"
+
+/********************* Internal functions *********************/
+static int fieldCell(real coordinate, real origin) {
+	return (int)floor((coordinate - origin) / FIELD_CELL_SIZE);
+}
+
+// Lists every attractor under each cell it reaches, a counting sort like spatialBuild
+static void fieldBuildGrid(ForceField *field) {
+	field->cellsX = 0;
+	field->cellsY = 0;
+	if (field->count == 0)
+		return;
+
+	// The grid only covers what the attractors can reach
+	real minX = field->attractors[0].x - field->attractors[0].radius;
+	real minY = field->attractors[0].y - field->attractors[0].radius;
+	real maxX = field->attractors[0].x + field->attractors[0].radius;
+	real maxY = field->attractors[0].y + field->attractors[0].radius;
+	for (int i = 1; i < field->count; i++) {
+		FieldAttractor *a = &field->attractors[i];
+		minX = fmin(minX, a->x - a->radius);
+		minY = fmin(minY, a->y - a->radius);
+		maxX = fmax(maxX, a->x + a->radius);
+		maxY = fmax(maxY, a->y + a->radius);
+	}
+	field->originX = floor(simClamp(minX, 0, WORLD_MAX_WIDTH) / FIELD_CELL_SIZE) * FIELD_CELL_SIZE;
+	field->originY = floor(simClamp(minY, 0, WORLD_MAX_HEIGHT) / FIELD_CELL_SIZE) * FIELD_CELL_SIZE;
+	field->cellsX = fieldCell(simClamp(maxX, 0, WORLD_MAX_WIDTH), field->originX) + 1;
+	field->cellsY = fieldCell(simClamp(maxY, 0, WORLD_MAX_HEIGHT), field->originY) + 1;
+	int cells = field->cellsX * field->cellsY;
+	if (cells + 1 > field->cellCapacity) {
+		field->cellCapacity = cells + 1;
+		field->cellStart = realloc(field->cellStart, field->cellCapacity * sizeof(int));
+	}
+
+	// Count then place, attractors stay in the order they were added within each cell
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 0) {
+			memset(field->cellStart, 0, (cells + 1) * sizeof(int));
+		} else {
+			for (int c = 0; c < cells; c++)
+				field->cellStart[c + 1] += field->cellStart[c];
+			if (field->cellStart[cells] > field->cellAttractorCapacity) {
+				field->cellAttractorCapacity = field->cellStart[cells];
+				field->cellAttractors = realloc(field->cellAttractors, field->cellAttractorCapacity * sizeof(int));
+			}
+		}
+		for (int i = 0; i < field->count; i++) {
+			FieldAttractor *a = &field->attractors[i];
+			int x0 = fieldCell(a->x - a->radius, field->originX);
+			int x1 = fieldCell(a->x + a->radius, field->originX);
+			int y0 = fieldCell(a->y - a->radius, field->originY);
+			int y1 = fieldCell(a->y + a->radius, field->originY);
+			x0 = x0 > 0 ? x0 : 0;
+			y0 = y0 > 0 ? y0 : 0;
+			x1 = x1 < field->cellsX - 1 ? x1 : field->cellsX - 1;
+			y1 = y1 < field->cellsY - 1 ? y1 : field->cellsY - 1;
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					int c = (y * field->cellsX) + x;
+					if (pass == 0)
+						field->cellStart[c + 1]++;
+					else
+						field->cellAttractors[field->cellStart[c]++] = i;
+				}
+			}
+		}
+	}
+
+	// cellStart[c] is left at the end of cell c by placing, shift it back to the start
+	for (int c = cells; c > 0; c--)
+		field->cellStart[c] = field->cellStart[c - 1];
+	field->cellStart[0] = 0;
+}
+
+/********************* Force field functions *********************/
+void fieldInit(ForceField *field) {
+	memset(field, 0, sizeof(ForceField));
+}
+
+void fieldFree(ForceField *field) {
+	free(field->attractors);
+	free(field->pending);
+	free(field->cellStart);
+	free(field->cellAttractors);
+	memset(field, 0, sizeof(ForceField));
+}
+
+void fieldClear(ForceField *field) {
+	field->pendingCount = 0;
+}
+
+void fieldAdd(ForceField *field, const FieldAttractor *attractor) {
+	if (field->pendingCount == field->pendingCapacity) {
+		field->pendingCapacity = field->pendingCapacity == 0 ? 8 : field->pendingCapacity * 2;
+		field->pending = realloc(field->pending, field->pendingCapacity * sizeof(FieldAttractor));
+	}
+	field->pending[field->pendingCount++] = *attractor;
+}
+
+void fieldBuild(ForceField *field) {
+	// Attractors hardly ever change, so most ticks this is one compare
+	if (field->pendingCount == field->count && (field->count == 0 || memcmp(field->pending, field->attractors, field->count * sizeof(FieldAttractor)) == 0))
+		return;
+	if (field->pendingCount > field->capacity) {
+		field->capacity = field->pendingCapacity;
+		field->attractors = realloc(field->attractors, field->capacity * sizeof(FieldAttractor));
+	}
+	field->count = field->pendingCount;
+	memcpy(field->attractors, field->pending, field->count * sizeof(FieldAttractor));
+	fieldBuildGrid(field);
+}
+
+bool fieldSample(const ForceField *field, real x, real y, FieldSample *sample) {
+	int cellX = fieldCell(x, field->originX);
+	int cellY = fieldCell(y, field->originY);
+	if (cellX < 0 || cellY < 0 || cellX >= field->cellsX || cellY >= field->cellsY)
+		return false;
+
+	// -0 so that adding the only pull there is gives exactly that pull, signed zeros and all
+	sample->acceleration.x = -0.0;
+	sample->acceleration.y = -0.0;
+	sample->pulled = false;
+	sample->swallowedBy = -1;
+	int c = (cellY * field->cellsX) + cellX;
+	for (int n = field->cellStart[c]; n < field->cellStart[c + 1]; n++) {
+		int i = field->cellAttractors[n];
+		const FieldAttractor *a = &field->attractors[i];
+		real dx = x - a->x;
+		real dy = y - a->y;
+		real distanceSquared = (dx * dx) + (dy * dy);
+		if (distanceSquared >= a->radius * a->radius)
+			continue;
+
+		// Scaling the offset by the distance gives the direction without any trig
+		real distance = sqrt(distanceSquared);
+		if (distance > a->grabRadius && distance > 0) {
+			real pull = a->strength / distance;
+			sample->acceleration.x += (a->x - x) * pull;
+			sample->acceleration.y += (a->y - y) * pull;
+			sample->pulled = true;
+		} else if (distance < a->grabRadius && sample->swallowedBy == -1) {
+			sample->swallowedBy = i;
+		}
+	}
+	return sample->pulled || sample->swallowedBy != -1;
+}
+
+const FieldAttractor *fieldAttractor(const ForceField *field, int i) {
+	return &field->attractors[i];
+}
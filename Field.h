@@ -0,0 +1,63 @@
+// Gravity from any number of attractors, each with its own radius and strength. Which attractors reach each cell of
+// a grid over their combined area is worked out once whenever they change, so sampling the field only looks at
+// the few attractors that can reach the point instead of every one of them
+#pragma once
+#include "Sim.h"
+
+/********************* Constants **********************/
+#define FIELD_CELL_SIZE ((real)256)
+
+/********************* Structs **********************/
+// Pulls anything within radius towards (x, y) at a constant strength, and swallows it inside grabRadius. Every
+// attractor is a garbage disposal for now, one with a grabRadius of 0 would only pull
+typedef struct {
+	real x;
+	real y;
+	real radius;
+	real strength;          // Pixels per tick per tick
+	real grabRadius;
+	EntityHandle owner;     // What the attractor belongs to, so whatever gets swallowed knows where it went
+} FieldAttractor;
+
+typedef struct {
+	FieldAttractor *attractors; // What the grid was built for
+	int count;
+	int capacity;
+	FieldAttractor *pending;    // Added since the last fieldClear
+	int pendingCount;
+	int pendingCapacity;
+
+	// Attractors reaching cell c are cellAttractors[cellStart[c]] to cellAttractors[cellStart[c + 1] - 1]
+	int *cellStart;
+	int *cellAttractors;
+	int cellAttractorCapacity;
+	int cellCapacity;
+	int cellsX;
+	int cellsY;
+	real originX;               // World position of the grid's first cell
+	real originY;
+} ForceField;
+
+// What the field does at a point
+typedef struct {
+	Vector acceleration;
+	bool pulled;        // Within an attractor's radius and outside of its grab radius
+	int swallowedBy;    // First attractor whose grab radius the point is in, -1 if none
+} FieldSample;
+
+/********************* Functions *********************/
+void fieldInit(ForceField *field);
+void fieldFree(ForceField *field);
+
+// Forgets the pending attractors, fieldAdd then fieldBuild to set them again
+void fieldClear(ForceField *field);
+void fieldAdd(ForceField *field, const FieldAttractor *attractor);
+
+// Makes the pending attractors the ones the field samples, the grid is only rebuilt if they've changed
+void fieldBuild(ForceField *field);
+
+// What the attractors do to something at (x, y), returns false if none of them reach it
+bool fieldSample(const ForceField *field, real x, real y, FieldSample *sample);
+
+// Attractor i as of the last fieldBuild
+const FieldAttractor *fieldAttractor(const ForceField *field, int i);
@@ -0,0 +1,163 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include "Jobs.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/********************* Structs **********************/
+typedef struct {
+	pthread_t thread;
+	atomic_int next; // Next chunk of this worker's run, past end once it's all been taken
+	int end;
+} JobWorker;
+
+typedef struct {
+	JobWorker workers[JOBS_MAX_WORKERS];
+	int workerCount;
+	pthread_mutex_t lock;
+	pthread_cond_t start;   // Signalled when there is a new parallel for
+	pthread_cond_t done;    // Signalled when the last worker finishes
+	long generation;        // Bumped every parallel for so workers can tell new work from a spurious wakeup
+	int busy;               // Threads still working on the current parallel for
+	bool quit;
+
+	// Current parallel for
+	JobFunc func;
+	void *data;
+	int count;
+	int chunkSize;
+} JobSystem;
+
+/********************* Globals *********************/
+static JobSystem gJobs = {};
+static _Thread_local bool gInJob = false; // This thread is running a chunk, parallel fors started from one run inline
+
+/********************* Internal functions *********************/
+static int jobsCoreCount() {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#else
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+static void jobsRunChunk(int chunk, int worker) {
+	int begin = chunk * gJobs.chunkSize;
+	int end = begin + gJobs.chunkSize < gJobs.count ? begin + gJobs.chunkSize : gJobs.count;
+	gInJob = true;
+	gJobs.func(chunk, begin, end, worker, gJobs.data);
+	gInJob = false;
+}
+
+// Works through this worker's run then steals from everyone else's until nothing is left
+static void jobsWork(int worker) {
+	for (int i = 0; i < gJobs.workerCount; i++) {
+		JobWorker *victim = &gJobs.workers[(worker + i) % gJobs.workerCount];
+		int chunk;
+		while ((chunk = atomic_fetch_add(&victim->next, 1)) < victim->end)
+			jobsRunChunk(chunk, worker);
+	}
+}
+
+static void *jobsThread(void *data) {
+	int worker = (int)(long)data;
+	long seen = 0;
+	pthread_mutex_lock(&gJobs.lock);
+	while (true) {
+		while (gJobs.generation == seen && !gJobs.quit)
+			pthread_cond_wait(&gJobs.start, &gJobs.lock);
+		if (gJobs.quit)
+			break;
+		seen = gJobs.generation;
+		pthread_mutex_unlock(&gJobs.lock);
+
+		jobsWork(worker);
+
+		pthread_mutex_lock(&gJobs.lock);
+		if (--gJobs.busy == 0)
+			pthread_cond_signal(&gJobs.done);
+	}
+	pthread_mutex_unlock(&gJobs.lock);
+	return NULL;
+}
+
+/********************* Job functions *********************/
+void jobsInit(int workers) {
+	jobsFree();
+	workers = workers <= 0 ? jobsCoreCount() : workers;
+	gJobs.workerCount = workers < JOBS_MAX_WORKERS ? workers : JOBS_MAX_WORKERS;
+	pthread_mutex_init(&gJobs.lock, NULL);
+	pthread_cond_init(&gJobs.start, NULL);
+	pthread_cond_init(&gJobs.done, NULL);
+	for (int i = 0; i < gJobs.workerCount; i++) {
+		atomic_init(&gJobs.workers[i].next, 0);
+		gJobs.workers[i].end = 0;
+	}
+	for (int i = 1; i < gJobs.workerCount; i++)
+		pthread_create(&gJobs.workers[i].thread, NULL, jobsThread, (void*)(long)i);
+}
+
+void jobsFree() {
+	if (gJobs.workerCount == 0)
+		return;
+	pthread_mutex_lock(&gJobs.lock);
+	gJobs.quit = true;
+	pthread_cond_broadcast(&gJobs.start);
+	pthread_mutex_unlock(&gJobs.lock);
+	for (int i = 1; i < gJobs.workerCount; i++)
+		pthread_join(gJobs.workers[i].thread, NULL);
+	pthread_mutex_destroy(&gJobs.lock);
+	pthread_cond_destroy(&gJobs.start);
+	pthread_cond_destroy(&gJobs.done);
+	memset(&gJobs, 0, sizeof(JobSystem));
+}
+
+int jobsWorkerCount() {
+	return gJobs.workerCount > 0 ? gJobs.workerCount : 1;
+}
+
+int jobsChunkCount(int count, int chunkSize) {
+	return (count + chunkSize - 1) / chunkSize;
+}
+
+void jobsParallelFor(int count, int chunkSize, JobFunc func, void *data) {
+	int chunks = jobsChunkCount(count, chunkSize);
+
+	// Not worth waking anyone up for, or everyone is already busy with the parallel for this is part of
+	if (gJobs.workerCount <= 1 || chunks <= 1 || gInJob) {
+		for (int chunk = 0; chunk < chunks; chunk++) {
+			int begin = chunk * chunkSize;
+			func(chunk, begin, begin + chunkSize < count ? begin + chunkSize : count, 0, data);
+		}
+		return;
+	}
+
+	// Each worker starts on its own contiguous run of chunks
+	pthread_mutex_lock(&gJobs.lock);
+	gJobs.func = func;
+	gJobs.data = data;
+	gJobs.count = count;
+	gJobs.chunkSize = chunkSize;
+	for (int i = 0; i < gJobs.workerCount; i++) {
+		atomic_store(&gJobs.workers[i].next, (chunks * i) / gJobs.workerCount);
+		gJobs.workers[i].end = (chunks * (i + 1)) / gJobs.workerCount;
+	}
+	gJobs.busy = gJobs.workerCount - 1;
+	gJobs.generation++;
+	pthread_cond_broadcast(&gJobs.start);
+	pthread_mutex_unlock(&gJobs.lock);
+
+	jobsWork(0);
+
+	pthread_mutex_lock(&gJobs.lock);
+	while (gJobs.busy > 0)
+		pthread_cond_wait(&gJobs.done, &gJobs.lock);
+	pthread_mutex_unlock(&gJobs.lock);
+}
@@ -0,0 +1,26 @@
+// Fixed pool of worker threads for splitting loops over the population across cores
+#pragma once
+#include <stdbool.h>
+
+/********************* Constants **********************/
+#define JOBS_MAX_WORKERS ((int)64)
+
+/********************* Types **********************/
+// Does chunk (items [begin, end)) of a parallel for, worker is which thread is running it from [0, jobsWorkerCount())
+typedef void (*JobFunc)(int chunk, int begin, int end, int worker, void *data);
+
+/********************* Functions *********************/
+// Starts workers - 1 threads (the caller is worker 0), 0 workers means one per core
+void jobsInit(int workers);
+void jobsFree();
+
+// 1 if jobsInit hasn't been called
+int jobsWorkerCount();
+
+// How many chunks jobsParallelFor will split count items into
+int jobsChunkCount(int count, int chunkSize);
+
+// Calls func for every chunk of [0, count) and returns once they are all done, chunks are handed
+// out in contiguous runs to each worker and workers that run out steal from the others. Called from
+// inside a chunk it runs every chunk in order on the calling thread instead
+void jobsParallelFor(int count, int chunkSize, JobFunc func, void *data);
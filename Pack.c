@@ -0,0 +1,128 @@
+#include <string.h>
+#include "Pack.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/********************* Constants **********************/
+static const char PACK_MAGIC[8] = {'L', 'E', 'C', 'D', 'P', 'A', 'K', '1'};
+#define PACK_HEADER_SIZE ((size_t)16)
+
+/********************* Internal functions *********************/
+// Maps the whole file read-only, returns NULL on failure
+static const unsigned char *packMap(const char *filename, size_t *size, void **mapping) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+	LARGE_INTEGER fileSize;
+	HANDLE handle = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	CloseHandle(file);
+	if (handle == NULL)
+		return NULL;
+	const unsigned char *data = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL) {
+		CloseHandle(handle);
+		return NULL;
+	}
+	*size = (size_t)fileSize.QuadPart;
+	*mapping = handle;
+	return data;
+#else
+	int file = open(filename, O_RDONLY);
+	if (file == -1)
+		return NULL;
+	struct stat st;
+	void *data = fstat(file, &st) == 0 && st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	close(file);
+	if (data == MAP_FAILED)
+		return NULL;
+	*size = st.st_size;
+	*mapping = NULL;
+	return data;
+#endif
+}
+
+static void packUnmap(Pack *pack) {
+#ifdef _WIN32
+	UnmapViewOfFile(pack->data);
+	CloseHandle(pack->mapping);
+#else
+	munmap((void*)pack->data, pack->size);
+#endif
+}
+
+/********************* Pack functions *********************/
+bool packOpen(Pack *pack, const char *filename) {
+	memset(pack, 0, sizeof(Pack));
+	pack->data = packMap(filename, &pack->size, &pack->mapping);
+	if (pack->data == NULL)
+		return false;
+
+	// Check the header then that every entry is inside the file before trusting any of it
+	bool ok = pack->size >= PACK_HEADER_SIZE && memcmp(pack->data, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0;
+	if (ok) {
+		uint32_t count;
+		memcpy(&count, pack->data + sizeof(PACK_MAGIC), sizeof(uint32_t));
+		ok = count <= (pack->size - PACK_HEADER_SIZE) / sizeof(PackEntry);
+		pack->entries = (const PackEntry*)(pack->data + PACK_HEADER_SIZE);
+		pack->count = ok ? (int)count : 0;
+	}
+	for (int i = 0; ok && i < pack->count; i++) {
+		const PackEntry *entry = &pack->entries[i];
+		ok = entry->offset <= pack->size && entry->size <= pack->size - entry->offset && memchr(entry->name, 0, PACK_NAME_LENGTH) != NULL;
+		if (ok && entry->type == PACK_ENTRY_PIXELS)
+			ok = (uint64_t)entry->width * entry->height * 4 == entry->size;
+		else if (ok && entry->type == PACK_ENTRY_SPRITE)
+			ok = entry->size == sizeof(uint32_t) * 2;
+	}
+
+	if (!ok)
+		packClose(pack);
+	return ok;
+}
+
+void packClose(Pack *pack) {
+	if (pack->data != NULL)
+		packUnmap(pack);
+	memset(pack, 0, sizeof(Pack));
+}
+
+const PackEntry *packFind(Pack *pack, const char *name) {
+	for (int i = 0; i < pack->count; i++)
+		if (strcmp(pack->entries[i].name, name) == 0)
+			return &pack->entries[i];
+	return NULL;
+}
+
+const void *packData(Pack *pack, const PackEntry *entry) {
+	return pack->data + entry->offset;
+}
+
+bool packMesh(Pack *pack, const PackEntry *entry, PackMesh *mesh) {
+	if (entry->type != PACK_ENTRY_MESH || entry->size < sizeof(uint32_t) * 2)
+		return false;
+	const unsigned char *data = packData(pack, entry);
+	memcpy(&mesh->vertexCount, data, sizeof(uint32_t));
+	memcpy(&mesh->indexCount, data + sizeof(uint32_t), sizeof(uint32_t));
+	uint64_t verticesSize = (uint64_t)mesh->vertexCount * 5 * sizeof(float);
+	if (sizeof(uint32_t) * 2 + verticesSize + ((uint64_t)mesh->indexCount * sizeof(uint16_t)) > entry->size)
+		return false;
+	mesh->vertices = (const float*)(data + sizeof(uint32_t) * 2);
+	mesh->indices = (const uint16_t*)(data + sizeof(uint32_t) * 2 + verticesSize);
+	return true;
+}
+
+bool packSprite(Pack *pack, const PackEntry *entry, uint32_t *x, uint32_t *y) {
+	if (entry->type != PACK_ENTRY_SPRITE)
+		return false;
+	const unsigned char *data = packData(pack, entry);
+	memcpy(x, data, sizeof(uint32_t));
+	memcpy(y, data + sizeof(uint32_t), sizeof(uint32_t));
+	return true;
+}
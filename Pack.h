@@ -0,0 +1,60 @@
+// Read-only view of an asset archive made by PackAssets.py, the whole file is memory mapped and entries point straight into it
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/********************* Types *********************/
+typedef enum {
+	PACK_ENTRY_RAW = 0,    // The file as is
+	PACK_ENTRY_PIXELS = 1, // width * height RGBA pixels, 8 bits per channel
+	PACK_ENTRY_MESH = 2,   // Indexed triangles, see PackMesh
+	PACK_ENTRY_SPRITE = 3, // width * height part of the atlas, see packSprite
+} packentry;
+
+/********************* Constants **********************/
+#define PACK_NAME_LENGTH ((int)56)
+#define PACK_ATLAS_NAME "atlas" // PACK_ENTRY_PIXELS entry every sprite is a part of
+
+/********************* Structs **********************/
+// Laid out exactly as it is in the file
+typedef struct {
+	char name[PACK_NAME_LENGTH]; // Path the asset was packed from, like "assets/Drone.png"
+	uint32_t type;
+	uint32_t width;              // Only for PACK_ENTRY_PIXELS and PACK_ENTRY_SPRITE
+	uint32_t height;
+	uint32_t reserved;
+	uint64_t offset;             // From the start of the file
+	uint64_t size;
+} PackEntry;
+
+// Each vertex is x, y, z, u, v
+typedef struct {
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	const float *vertices;
+	const uint16_t *indices;
+} PackMesh;
+
+typedef struct {
+	const unsigned char *data; // The mapped file
+	size_t size;
+	const PackEntry *entries;
+	int count;
+	void *mapping;             // Platform handle keeping data mapped
+} Pack;
+
+/********************* Functions *********************/
+// Maps an archive, returns false if it can't be opened or isn't a valid archive
+bool packOpen(Pack *pack, const char *filename);
+void packClose(Pack *pack);
+
+// Returns the entry packed from name or NULL if there isn't one
+const PackEntry *packFind(Pack *pack, const char *name);
+const void *packData(Pack *pack, const PackEntry *entry);
+
+// Fills out mesh from a PACK_ENTRY_MESH entry, returns false if it isn't a valid mesh
+bool packMesh(Pack *pack, const PackEntry *entry, PackMesh *mesh);
+
+// Gets where a PACK_ENTRY_SPRITE entry is in the atlas, returns false if it isn't a sprite
+bool packSprite(Pack *pack, const PackEntry *entry, uint32_t *x, uint32_t *y);
@@ -0,0 +1,220 @@
+# Packs what Assets.h lists into assets/Assets.pak so the game can map it in one go instead of
+# loading and decoding each file. PNGs are stored as raw RGBA pixels, OBJs as an indexed triangle
+# mesh and anything else as is. Sprites are packed together into one atlas texture so they can all be
+# drawn without switching textures. Run it from the repository root whenever the assets change,
+# -o writes the archive somewhere else.
+#
+# Layout, all little endian:
+#   header  "LECDPAK1", u32 entry count, u32 reserved
+#   entries char name[56], u32 type, u32 width, u32 height, u32 reserved, u64 offset, u64 size
+#   data    each entry's data starts on a PACK_ALIGNMENT boundary
+# Meshes are u32 vertex count, u32 index count, then x/y/z/u/v floats per vertex then u16 indices.
+# Sprites are u32 x, u32 y of where they are in the atlas entry, their width and height are in the entry.
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+ASSETS_HEADER = "Assets.h"
+PACK_FILE = "assets/Assets.pak"
+PACK_MAGIC = b"LECDPAK1"
+PACK_NAME_LENGTH = 56
+PACK_ALIGNMENT = 16
+
+PACK_ENTRY_RAW = 0
+PACK_ENTRY_PIXELS = 1
+PACK_ENTRY_MESH = 2
+PACK_ENTRY_SPRITE = 3
+
+# Drawn as sprites, the backgrounds repeat and the font and model manage their own textures so they stay separate
+ATLAS_NAME = "atlas"
+ATLAS_WIDTH = 1024
+ATLAS_PADDING = 2
+ATLAS_SPRITES = [
+    "assets/Player.png",
+    "assets/PlayerThruster.png",
+    "assets/Drone.png",
+    "assets/Mine.png",
+    "assets/Trash1.png",
+    "assets/Trash2.png",
+    "assets/Arrow.png",
+    "assets/HP.png",
+]
+
+# Listed in Assets.h but never read from the archive, JamUtil's font only loads from a file so Font.png stays loose
+PACK_SKIP = [
+    "assets/Font.png",
+]
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+
+# Only what the game's assets use, 8 bit RGBA without interlacing
+def decode_png(filename):
+    with open(filename, "rb") as f:
+        data = f.read()
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError(filename + " is not a PNG")
+    pos = 8
+    idat = b""
+    width = height = 0
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += length + 12
+        if kind == b"IHDR":
+            width, height, depth, colour, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+            if depth != 8 or colour != 6 or interlace != 0:
+                raise ValueError(filename + " must be 8 bit RGBA without interlacing")
+        elif kind == b"IDAT":
+            idat += chunk
+        elif kind == b"IEND":
+            break
+
+    # Undo each row's filter, every pixel is 4 bytes
+    raw = zlib.decompress(idat)
+    stride = width * 4
+    pixels = bytearray(stride * height)
+    previous = bytearray(stride)
+    for y in range(height):
+        filter_type = raw[y * (stride + 1)]
+        row = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for x in range(stride):
+            left = row[x - 4] if x >= 4 else 0
+            up = previous[x]
+            up_left = previous[x - 4] if x >= 4 else 0
+            if filter_type == 1:
+                row[x] = (row[x] + left) & 0xff
+            elif filter_type == 2:
+                row[x] = (row[x] + up) & 0xff
+            elif filter_type == 3:
+                row[x] = (row[x] + ((left + up) >> 1)) & 0xff
+            elif filter_type == 4:
+                p = left + up - up_left
+                pa, pb, pc = abs(p - left), abs(p - up), abs(p - up_left)
+                predictor = left if pa <= pb and pa <= pc else (up if pb <= pc else up_left)
+                row[x] = (row[x] + predictor) & 0xff
+        pixels[y * stride:(y + 1) * stride] = row
+        previous = row
+    return width, height, bytes(pixels)
+
+
+# Triangulates faces and merges corners that share a position and texture coordinate
+def convert_obj(filename):
+    positions = []
+    uvs = []
+    vertices = []
+    indices = []
+    lookup = {}
+    with open(filename, "r") as f:
+        for line in f:
+            parts = line.split()
+            if not parts:
+                continue
+            if parts[0] == "v":
+                positions.append(tuple(float(p) for p in parts[1:4]))
+            elif parts[0] == "vt":
+                uvs.append((float(parts[1]), float(parts[2])))
+            elif parts[0] == "f":
+                corners = []
+                for corner in parts[1:]:
+                    fields = corner.split("/")
+                    position = int(fields[0]) - 1
+                    uv = int(fields[1]) - 1 if len(fields) > 1 and fields[1] else -1
+                    key = (position, uv)
+                    if key not in lookup:
+                        lookup[key] = len(vertices)
+                        u, v = uvs[uv] if uv >= 0 else (0, 0)
+                        vertices.append(positions[position] + (u, 1 - v)) # Vulkan's texture origin is the top left
+                    corners.append(lookup[key])
+                for i in range(1, len(corners) - 1):
+                    indices += [corners[0], corners[i], corners[i + 1]]
+    if len(vertices) > 0xffff:
+        raise ValueError(filename + " has too many vertices for 16 bit indices")
+    data = struct.pack("<II", len(vertices), len(indices))
+    data += b"".join(struct.pack("<5f", *vertex) for vertex in vertices)
+    data += struct.pack("<%iH" % len(indices), *indices)
+    return data
+
+
+# Shelf packs the sprites tallest first, returns the atlas' width, height and pixels and each sprite's x and y in it
+def build_atlas(sprites):
+    order = sorted(sprites, key=lambda name: -sprites[name][1])
+    places = {}
+    x = y = shelf = 0
+    for name in order:
+        width, height, _ = sprites[name]
+        if x + width > ATLAS_WIDTH:
+            x = 0
+            y += shelf + ATLAS_PADDING
+            shelf = 0
+        places[name] = (x, y)
+        x += width + ATLAS_PADDING
+        shelf = max(shelf, height)
+    atlas_height = y + shelf
+
+    pixels = bytearray(ATLAS_WIDTH * atlas_height * 4)
+    for name, (x, y) in places.items():
+        width, height, data = sprites[name]
+        for row in range(height):
+            start = ((y + row) * ATLAS_WIDTH + x) * 4
+            pixels[start:start + width * 4] = data[row * width * 4:(row + 1) * width * 4]
+    return ATLAS_WIDTH, atlas_height, bytes(pixels), places
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Packs the assets listed in %s into one archive the game maps at startup." % ASSETS_HEADER)
+    parser.add_argument("-o", "--output", default=PACK_FILE, help="where to write the archive (default: %(default)s)")
+    args = parser.parse_args()
+
+    with open(ASSETS_HEADER, "r") as f:
+        files = re.findall(r'\{"([^"]+)"\}', f.read())
+
+    entries = []
+    blobs = []
+    sprites = {}
+    for filename in files:
+        if len(filename) >= PACK_NAME_LENGTH:
+            raise ValueError(filename + " is too long a name")
+        if filename in PACK_SKIP:
+            continue
+        if filename in ATLAS_SPRITES:
+            sprites[filename] = decode_png(filename)
+            continue
+        if filename.endswith(".png"):
+            width, height, data = decode_png(filename)
+            entries.append((filename, PACK_ENTRY_PIXELS, width, height))
+        elif filename.endswith(".obj"):
+            data = convert_obj(filename)
+            entries.append((filename, PACK_ENTRY_MESH, 0, 0))
+        else:
+            with open(filename, "rb") as f:
+                data = f.read()
+            entries.append((filename, PACK_ENTRY_RAW, 0, 0))
+        blobs.append(data)
+
+    width, height, data, places = build_atlas(sprites)
+    entries.append((ATLAS_NAME, PACK_ENTRY_PIXELS, width, height))
+    blobs.append(data)
+    for name in ATLAS_SPRITES:
+        entries.append((name, PACK_ENTRY_SPRITE, sprites[name][0], sprites[name][1]))
+        blobs.append(struct.pack("<II", *places[name]))
+
+    entry_format = "<%is4I2Q" % PACK_NAME_LENGTH
+    offset = 16 + (len(entries) * struct.calcsize(entry_format))
+    table = b""
+    body = b""
+    for (name, kind, width, height), data in zip(entries, blobs):
+        padding = -(offset + len(body)) % PACK_ALIGNMENT
+        body += b"\0" * padding
+        table += struct.pack(entry_format, name.encode(), kind, width, height, 0, offset + len(body), len(data))
+        body += data
+
+    with open(args.output, "wb") as f:
+        f.write(PACK_MAGIC + struct.pack("<II", len(entries), 0) + table + body)
+    print("Packed %i assets into %s (%i bytes)" % (len(entries), args.output, 16 + len(table) + len(body)))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Profile.h"
+
+/********************* Constants **********************/
+#define PROFILE_MAX_DEPTH ((int)32)
+
+static const char *PROFILE_ZONE_NAMES[PROFILE_ZONE_MAX] = {
+	"frame", "input", "disposal_render", "background", "sim", "player", "entities",
+	"spatial", "collisions", "draw_entities", "ui", "end_frame", "wait",
+};
+
+static const char *PROFILE_COUNTER_NAMES[PROFILE_COUNTER_MAX] = {
+	"visible", "culled",
+};
+
+/********************* Structs **********************/
+typedef struct {
+	profilezone zone;
+	double start; // Seconds
+	double duration;
+} ProfileEvent;
+
+typedef struct {
+	double open[PROFILE_MAX_DEPTH];                      // Start times of the zones currently open
+	int depth;
+	double frame[PROFILE_ZONE_MAX];                      // Seconds in each zone so far this frame
+	double history[PROFILE_HISTORY_FRAMES][PROFILE_ZONE_MAX];
+	int historyFrame;
+	long counterFrame[PROFILE_COUNTER_MAX];              // Counts so far this frame
+	long counterHistory[PROFILE_HISTORY_FRAMES][PROFILE_COUNTER_MAX];
+	double total[PROFILE_ZONE_MAX];
+	long calls[PROFILE_ZONE_MAX];
+	ProfileEvent *trace;                                 // NULL unless a capture is running
+	int traceCount;
+	bool paused;
+} Profiler;
+
+/********************* Globals *********************/
+static Profiler gProfiler = {};
+
+/********************* Internal functions *********************/
+static double profileTime() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+/********************* Profile functions *********************/
+void profileBegin(profilezone zone) {
+	if (gProfiler.paused)
+		return;
+	if (gProfiler.depth < PROFILE_MAX_DEPTH)
+		gProfiler.open[gProfiler.depth] = profileTime();
+	gProfiler.depth++;
+}
+
+void profileEnd(profilezone zone) {
+	if (gProfiler.paused)
+		return;
+	gProfiler.depth--;
+	if (gProfiler.depth >= PROFILE_MAX_DEPTH || gProfiler.depth < 0)
+		return;
+	double start = gProfiler.open[gProfiler.depth];
+	double duration = profileTime() - start;
+	gProfiler.frame[zone] += duration;
+	gProfiler.total[zone] += duration;
+	gProfiler.calls[zone]++;
+	if (gProfiler.trace != NULL && gProfiler.traceCount < PROFILE_TRACE_CAPACITY) {
+		ProfileEvent *event = &gProfiler.trace[gProfiler.traceCount++];
+		event->zone = zone;
+		event->start = start;
+		event->duration = duration;
+	}
+}
+
+void profileFrame() {
+	for (int i = 0; i < PROFILE_ZONE_MAX; i++) {
+		gProfiler.history[gProfiler.historyFrame][i] = gProfiler.frame[i];
+		gProfiler.frame[i] = 0;
+	}
+	for (int i = 0; i < PROFILE_COUNTER_MAX; i++) {
+		gProfiler.counterHistory[gProfiler.historyFrame][i] = gProfiler.counterFrame[i];
+		gProfiler.counterFrame[i] = 0;
+	}
+	gProfiler.historyFrame = (gProfiler.historyFrame + 1) % PROFILE_HISTORY_FRAMES;
+}
+
+const char *profileZoneName(profilezone zone) {
+	return PROFILE_ZONE_NAMES[zone];
+}
+
+void profileCount(profilecounter counter, long amount) {
+	if (gProfiler.paused)
+		return;
+	gProfiler.counterFrame[counter] += amount;
+}
+
+void profilePause(bool paused) {
+	gProfiler.paused = paused;
+}
+
+const char *profileCounterName(profilecounter counter) {
+	return PROFILE_COUNTER_NAMES[counter];
+}
+
+double profileCounterAverage(profilecounter counter) {
+	long total = 0;
+	for (int i = 0; i < PROFILE_HISTORY_FRAMES; i++)
+		total += gProfiler.counterHistory[i][counter];
+	return (double)total / PROFILE_HISTORY_FRAMES;
+}
+
+double profileZoneAverage(profilezone zone) {
+	double total = 0;
+	for (int i = 0; i < PROFILE_HISTORY_FRAMES; i++)
+		total += gProfiler.history[i][zone];
+	return (total / PROFILE_HISTORY_FRAMES) * 1000;
+}
+
+double profileZoneTotal(profilezone zone) {
+	return gProfiler.total[zone];
+}
+
+long profileZoneCalls(profilezone zone) {
+	return gProfiler.calls[zone];
+}
+
+void profileReset() {
+	for (int i = 0; i < PROFILE_ZONE_MAX; i++) {
+		gProfiler.total[i] = 0;
+		gProfiler.calls[i] = 0;
+	}
+}
+
+void profileTraceStart() {
+	if (gProfiler.trace == NULL)
+		gProfiler.trace = malloc(PROFILE_TRACE_CAPACITY * sizeof(ProfileEvent));
+	gProfiler.traceCount = 0;
+}
+
+bool profileTraceRunning() {
+	return gProfiler.trace != NULL;
+}
+
+bool profileTraceSave(const char *filename) {
+	if (gProfiler.trace == NULL)
+		return false;
+	FILE *f = fopen(filename, "w");
+	bool ok = f != NULL;
+	if (ok) {
+		// Complete events in microseconds from the start of the capture
+		double origin = gProfiler.traceCount > 0 ? gProfiler.trace[0].start : 0;
+		for (int i = 0; i < gProfiler.traceCount; i++)
+			origin = gProfiler.trace[i].start < origin ? gProfiler.trace[i].start : origin;
+		fprintf(f, "{\"traceEvents\": [\n");
+		for (int i = 0; i < gProfiler.traceCount; i++) {
+			ProfileEvent *event = &gProfiler.trace[i];
+			fprintf(f, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+					PROFILE_ZONE_NAMES[event->zone], (event->start - origin) * 1000000, event->duration * 1000000,
+					i < gProfiler.traceCount - 1 ? "," : "");
+		}
+		fprintf(f, "]}\n");
+		ok = fclose(f) == 0;
+	}
+	free(gProfiler.trace);
+	gProfiler.trace = NULL;
+	gProfiler.traceCount = 0;
+	return ok;
+}
@@ -0,0 +1,79 @@
+// Scoped timing of the phases of a frame, for an overlay and Chrome trace (chrome://tracing) exports. Zones are only
+// recorded when built with LECD_PROFILE, otherwise the PROFILE_* macros compile to nothing. Main thread only.
+#pragma once
+#include <stdbool.h>
+
+/********************* Types *********************/
+typedef enum {
+	PROFILE_ZONE_FRAME = 0,
+	PROFILE_ZONE_INPUT = 1,            // juUpdate and SDL events
+	PROFILE_ZONE_DISPOSAL_RENDER = 2,  // Rendering the garbage disposal model to its texture
+	PROFILE_ZONE_BACKGROUND = 3,
+	PROFILE_ZONE_SIM = 4,              // All of simUpdate
+	PROFILE_ZONE_PLAYER = 5,           // playerUpdate
+	PROFILE_ZONE_ENTITIES = 6,         // popUpdateEntities
+	PROFILE_ZONE_SPATIAL = 7,          // Rebuilding the spatial hash
+	PROFILE_ZONE_COLLISIONS = 8,       // popCollideEntities
+	PROFILE_ZONE_DRAW_ENTITIES = 9,
+	PROFILE_ZONE_UI = 10,              // gameDrawUI
+	PROFILE_ZONE_END_FRAME = 11,       // vk2dRendererEndFrame
+	PROFILE_ZONE_WAIT = 12,            // Framerate limiter
+	PROFILE_ZONE_MAX = 13,
+} profilezone;
+
+// Per frame counts of things, shown alongside the zones
+typedef enum {
+	PROFILE_COUNTER_VISIBLE = 0,       // Entities drawn
+	PROFILE_COUNTER_CULLED = 1,        // Entities skipped for being off screen
+	PROFILE_COUNTER_MAX = 2,
+} profilecounter;
+
+/********************* Constants **********************/
+#define PROFILE_HISTORY_FRAMES ((int)60)     // Averages are over this many frames
+#define PROFILE_TRACE_CAPACITY ((int)262144) // Zones a trace capture can hold before it stops recording
+
+/********************* Macros *********************/
+#ifdef LECD_PROFILE
+#define PROFILE_BEGIN(zone) profileBegin(zone)
+#define PROFILE_END(zone) profileEnd(zone)
+#define PROFILE_FRAME() profileFrame()
+#define PROFILE_COUNT(counter, amount) profileCount(counter, amount)
+#else
+#define PROFILE_BEGIN(zone)
+#define PROFILE_END(zone)
+#define PROFILE_FRAME()
+#define PROFILE_COUNT(counter, amount)
+#endif
+
+/********************* Functions *********************/
+// Zones can nest but must end in the opposite order they began
+void profileBegin(profilezone zone);
+void profileEnd(profilezone zone);
+
+// Call once a frame, rolls this frame's times into the averages
+void profileFrame();
+
+const char *profileZoneName(profilezone zone);
+
+// Adds amount to counter for this frame
+void profileCount(profilecounter counter, long amount);
+const char *profileCounterName(profilecounter counter);
+
+// Average of counter per frame over the last PROFILE_HISTORY_FRAMES frames
+double profileCounterAverage(profilecounter counter);
+
+// Average milliseconds per frame spent in zone over the last PROFILE_HISTORY_FRAMES frames
+double profileZoneAverage(profilezone zone);
+
+// Seconds spent in zone and times it was entered since the last profileReset
+double profileZoneTotal(profilezone zone);
+long profileZoneCalls(profilezone zone);
+void profileReset();
+
+// Zones and counts are ignored while paused, for running the simulation off the main thread
+void profilePause(bool paused);
+
+// Trace captures record every zone until stopped, saving writes them as Chrome trace JSON and returns false on failure
+void profileTraceStart();
+bool profileTraceRunning();
+bool profileTraceSave(const char *filename);
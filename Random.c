@@ -0,0 +1,29 @@
+#include "Random.h"
+
+/********************* Internal functions *********************/
+static const uint64_t RANDOM_GOLDEN_GAMMA = 0x9e3779b97f4a7c15ull;
+
+// SplitMix64 finalizer, a bijection that scrambles all 64 bits
+static uint64_t randomMix(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+/********************* Random functions *********************/
+void randomStreamSeed(RandomStream *stream, uint64_t seed, uint64_t id) {
+	stream->key = randomMix(seed ^ randomMix((id + 1) * RANDOM_GOLDEN_GAMMA));
+	stream->counter = 0;
+}
+
+uint64_t randomStreamAt(const RandomStream *stream, uint64_t counter) {
+	return randomMix(stream->key + ((counter + 1) * RANDOM_GOLDEN_GAMMA));
+}
+
+uint64_t randomStreamNext(RandomStream *stream) {
+	return randomStreamAt(stream, stream->counter++);
+}
+
+double randomStreamDouble(RandomStream *stream) {
+	return (double)(randomStreamNext(stream) >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,23 @@
+// Counter-based random numbers, every stream is independent and can be jumped to any point
+#pragma once
+#include <stdint.h>
+
+/********************* Structs **********************/
+// Draw n of a stream is a pure function of (key, n) so streams never share state
+typedef struct {
+	uint64_t key;     // Picked by seed and stream id
+	uint64_t counter; // Draws taken so far
+} RandomStream;
+
+/********************* Functions *********************/
+// Sets up stream id of seed, different ids give unrelated sequences for the same seed
+void randomStreamSeed(RandomStream *stream, uint64_t seed, uint64_t id);
+
+// Returns the next 64 random bits and advances the stream
+uint64_t randomStreamNext(RandomStream *stream);
+
+// Returns what draw counter of the stream is/was without touching it, for filling batches out of order
+uint64_t randomStreamAt(const RandomStream *stream, uint64_t counter);
+
+// Returns a double from [0, 1) with the full 53 bits of precision
+double randomStreamDouble(RandomStream *stream);
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Replay.h"
+#include "World.h"
+
+/********************* Constants **********************/
+static const char REPLAY_MAGIC[8] = {'L', 'E', 'C', 'D', 'R', 'P', 'L', '2'};
+static const char REPLAY_MAGIC_1[8] = {'L', 'E', 'C', 'D', 'R', 'P', 'L', '1'}; // Header without lod, always played with it on
+
+enum {
+	REPLAY_INPUT_LEFT          = 1 << 0,
+	REPLAY_INPUT_RIGHT         = 1 << 1,
+	REPLAY_INPUT_THRUST        = 1 << 2,
+	REPLAY_INPUT_GRAB_PRESSED  = 1 << 3,
+	REPLAY_INPUT_GRAB_RELEASED = 1 << 4,
+	REPLAY_INPUT_VIEW          = 1 << 5, // View size changed this tick
+};
+
+// File header, followed by the tick records
+typedef struct {
+	char magic[8];
+	uint64_t seed;
+	int64_t ticks;
+	real view[4];
+	uint8_t lod;
+	uint8_t reserved[7];
+} ReplayHeader;
+
+/********************* Internal functions *********************/
+static void replayWrite(Replay *replay, const void *data, size_t size) {
+	if (replay->size + size > replay->capacity) {
+		replay->capacity = replay->capacity == 0 ? 4096 : replay->capacity * 2;
+		replay->data = realloc(replay->data, replay->capacity);
+	}
+	memcpy(replay->data + replay->size, data, size);
+	replay->size += size;
+}
+
+// Returns false if the log runs out
+static bool replayRead(Replay *replay, void *data, size_t size) {
+	if (replay->cursor + size > replay->size)
+		return false;
+	memcpy(data, replay->data + replay->cursor, size);
+	replay->cursor += size;
+	return true;
+}
+
+static bool replayIsCheckpoint(long tick) {
+	return tick % REPLAY_CHECKPOINT_INTERVAL == 0;
+}
+
+/********************* Replay functions *********************/
+void replayStartRecording(Replay *replay, uint64_t seed, SimView view) {
+	replay->seed = seed;
+	replay->view = view;
+	replay->lod = gWorld->lod;
+	replay->ticks = 0;
+	replay->size = 0;
+	replayRewind(replay);
+}
+
+void replayRecord(Replay *replay, const PlayerInput *input) {
+	uint8_t flags = (input->left ? REPLAY_INPUT_LEFT : 0) | (input->right ? REPLAY_INPUT_RIGHT : 0) |
+					(input->thrust ? REPLAY_INPUT_THRUST : 0) | (input->grabPressed ? REPLAY_INPUT_GRAB_PRESSED : 0) |
+					(input->grabReleased ? REPLAY_INPUT_GRAB_RELEASED : 0);
+
+	// The view size decides where things spawn so it has to be played back too
+	bool viewChanged = gWorld->view.w != replay->viewW || gWorld->view.h != replay->viewH;
+	if (viewChanged)
+		flags |= REPLAY_INPUT_VIEW;
+	replayWrite(replay, &flags, sizeof(flags));
+	if (viewChanged) {
+		replay->viewW = gWorld->view.w;
+		replay->viewH = gWorld->view.h;
+		replayWrite(replay, &replay->viewW, sizeof(real));
+		replayWrite(replay, &replay->viewH, sizeof(real));
+	}
+
+	replay->tick++;
+	replay->ticks = replay->tick;
+	if (replayIsCheckpoint(replay->tick)) {
+		uint64_t hash = simHash();
+		replayWrite(replay, &hash, sizeof(hash));
+	}
+}
+
+void replayRewind(Replay *replay) {
+	replay->cursor = 0;
+	replay->tick = 0;
+	replay->viewW = replay->view.w;
+	replay->viewH = replay->view.h;
+}
+
+bool replayNext(Replay *replay, PlayerInput *input) {
+	uint8_t flags;
+	if (replay->tick >= replay->ticks || !replayRead(replay, &flags, sizeof(flags)))
+		return false;
+	input->left = (flags & REPLAY_INPUT_LEFT) != 0;
+	input->right = (flags & REPLAY_INPUT_RIGHT) != 0;
+	input->thrust = (flags & REPLAY_INPUT_THRUST) != 0;
+	input->grabPressed = (flags & REPLAY_INPUT_GRAB_PRESSED) != 0;
+	input->grabReleased = (flags & REPLAY_INPUT_GRAB_RELEASED) != 0;
+	if (flags & REPLAY_INPUT_VIEW) {
+		if (!replayRead(replay, &replay->viewW, sizeof(real)) || !replayRead(replay, &replay->viewH, sizeof(real)))
+			return false;
+	}
+	gWorld->view.w = replay->viewW;
+	gWorld->view.h = replay->viewH;
+	return true;
+}
+
+bool replayVerify(Replay *replay) {
+	replay->tick++;
+	uint64_t hash;
+	if (!replayIsCheckpoint(replay->tick))
+		return true;
+	return replayRead(replay, &hash, sizeof(hash)) && hash == simHash();
+}
+
+bool replaySave(Replay *replay, const char *filename) {
+	FILE *f = fopen(filename, "wb");
+	if (f == NULL)
+		return false;
+	ReplayHeader header = {};
+	memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+	header.seed = replay->seed;
+	header.ticks = replay->ticks;
+	header.view[0] = replay->view.x;
+	header.view[1] = replay->view.y;
+	header.view[2] = replay->view.w;
+	header.view[3] = replay->view.h;
+	header.lod = replay->lod;
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(replay->data, 1, replay->size, f) == replay->size;
+	return fclose(f) == 0 && ok;
+}
+
+bool replayLoad(Replay *replay, const char *filename) {
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL)
+		return false;
+	ReplayHeader header;
+	size_t headerSize = offsetof(ReplayHeader, lod);
+	bool ok = fread(&header, headerSize, 1, f) == 1;
+	if (ok && memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0) {
+		ok = fread((uint8_t*)&header + headerSize, sizeof(header) - headerSize, 1, f) == 1;
+	} else if (ok && memcmp(header.magic, REPLAY_MAGIC_1, sizeof(REPLAY_MAGIC_1)) == 0) {
+		header.lod = true;
+	} else {
+		ok = false;
+	}
+	if (!ok) {
+		fclose(f);
+		return false;
+	}
+
+	// Rest of the file is the tick records
+	replay->size = 0;
+	uint8_t buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		replayWrite(replay, buffer, read);
+	fclose(f);
+
+	replay->seed = header.seed;
+	replay->ticks = header.ticks;
+	replay->view.x = header.view[0];
+	replay->view.y = header.view[1];
+	replay->view.w = header.view[2];
+	replay->view.h = header.view[3];
+	replay->lod = header.lod != 0;
+	replayRewind(replay);
+	return true;
+}
+
+void replayFree(Replay *replay) {
+	free(replay->data);
+	memset(replay, 0, sizeof(Replay));
+}
@@ -0,0 +1,51 @@
+// Recording and playback of a single game's input so it can be run again exactly
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Sim.h"
+
+/********************* Constants **********************/
+#define REPLAY_CHECKPOINT_INTERVAL ((long)60) // A world hash is stored every this many ticks
+
+/********************* Structs **********************/
+// Log of a game, data holds one record per tick in the same layout as the file:
+//  - one byte of REPLAY_INPUT_* flags
+//  - if REPLAY_INPUT_VIEW is set, the new view width and height as doubles
+//  - every REPLAY_CHECKPOINT_INTERVAL ticks, simHash() after the tick
+typedef struct {
+	uint64_t seed;
+	SimView view;     // View the game was started with
+	bool lod;         // gWorld->lod the game was played with
+	long ticks;       // Ticks in the log
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+	size_t cursor;    // Read position during playback
+	long tick;        // Ticks recorded or played so far
+	real viewW;       // View size as of the last tick recorded or played
+	real viewH;
+} Replay;
+
+/********************* Functions *********************/
+// Starts logging a game that was/will be started with simStart(seed, view), gWorld->lod is logged as it is now
+// and mustn't change until the recording is over
+void replayStartRecording(Replay *replay, uint64_t seed, SimView view);
+
+// Logs a tick, call right after simUpdate with the input that was given to it
+void replayRecord(Replay *replay, const PlayerInput *input);
+
+// Returns to the start of the log, simStart(replay->seed, replay->view) and setting gWorld->lod to replay->lod
+// should be done alongside it
+void replayRewind(Replay *replay);
+
+// Fills out the next tick's input and view size, returns false once the log is over
+bool replayNext(Replay *replay, PlayerInput *input);
+
+// Call right after simUpdate during playback, returns false if the world has diverged from the recording
+bool replayVerify(Replay *replay);
+
+// Both return false if the file couldn't be written/read or isn't a replay
+bool replaySave(Replay *replay, const char *filename);
+bool replayLoad(Replay *replay, const char *filename);
+
+void replayFree(Replay *replay);
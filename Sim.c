@@ -0,0 +1,1117 @@
+#include <stdlib.h>
+#include <string.h>
+#include "World.h"
+#include "Jobs.h"
+#include "Profile.h"
+
+/********************* Globals *********************/
+static SimWorld gDefaultWorld = {.garbageDisposal = NO_ENTITY, .enemyMax = 1, .lod = true};
+_Thread_local SimWorld *gWorld = &gDefaultWorld;
+
+/********************* Math functions *********************/
+real simPointDistance(real x1, real y1, real x2, real y2) {
+	return sqrt(pow(y2 - y1, 2) + pow(x2 - x1, 2));
+}
+
+real simPointAngle(real x1, real y1, real x2, real y2) {
+	return atan2(x2 - x1, y2 - y1) - (SIM_PI / 2);
+}
+
+real simCastX(real length, real angle) {
+	return cos(angle) * length;
+}
+
+real simCastY(real length, real angle) {
+	return -sin(angle) * length;
+}
+
+real simClamp(real x, real min, real max) {
+	return x < min ? min : (x > max ? max : x);
+}
+
+real simSign(real x) {
+	return x > 0 ? 1 : (x < 0 ? -1 : 0);
+}
+
+/********************* Common functions *********************/
+void randomSeed(uint64_t seed) {
+	for (int i = 0; i < RANDOM_STREAM_MAX; i++)
+		randomStreamSeed(&gWorld->random[i], seed, i);
+}
+
+// Returns a real from [0, 1)
+real randomReal(randomstream stream) {
+	return randomStreamDouble(&gWorld->random[stream]);
+}
+
+// Returns an int from [low, high)
+int randomRange(randomstream stream, int low, int high) {
+	return low + (int)floor(randomReal(stream) * (high - low));
+}
+
+// Returns a real number from low to high
+real randomRangeReal(randomstream stream, real low, real high) {
+	return low + (randomReal(stream) * (high - low));
+}
+
+/********************* Physics functions *********************/
+void physicsStart(Physics *physics, real x, real y) {
+	physics->x = x;
+	physics->y = y;
+	physics->velocity.x = 0;
+	physics->velocity.y = 0;
+}
+
+Vector vectorFromAngle(real length, real angle) {
+	Vector v = {cos(angle) * length, sin(angle) * length};
+	return v;
+}
+
+void physicsAccelerate(real *vx, real *vy, real ax, real ay) {
+	*vx += ax;
+	*vy += ay;
+
+	// Only pay for the sqrt when the cap actually kicks in
+	real speedSquared = (*vx * *vx) + (*vy * *vy);
+	if (speedSquared > PHYSICS_BASE_TOP_SPEED * PHYSICS_BASE_TOP_SPEED) {
+		real scale = PHYSICS_BASE_TOP_SPEED / sqrt(speedSquared);
+		*vx *= scale;
+		*vy *= scale;
+	}
+}
+
+void physicsIntegrate(real * restrict x, real * restrict y, const real * restrict vx, const real * restrict vy, int count) {
+	for (int i = 0; i < count; i++) {
+		real nx = x[i] + vx[i];
+		real ny = y[i] + vy[i];
+		nx = nx < 0 ? 0 : nx;
+		ny = ny < 0 ? 0 : ny;
+		x[i] = nx > WORLD_MAX_WIDTH ? WORLD_MAX_WIDTH : nx;
+		y[i] = ny > WORLD_MAX_HEIGHT ? WORLD_MAX_HEIGHT : ny;
+	}
+}
+
+void physicsUpdate(Physics *physics, Vector *acceleration) {
+	if (acceleration != NULL)
+		physicsAccelerate(&physics->velocity.x, &physics->velocity.y, acceleration->x, acceleration->y);
+	physicsIntegrate(&physics->x, &physics->y, &physics->velocity.x, &physics->velocity.y, 1);
+}
+
+/********************* Trash functions *********************/
+void trashStart(int i) {
+	TrashPool *trash = &gWorld->population.trash;
+	trash->variant[i] = randomRange(RANDOM_STREAM_TRASH, 0, TRASH_VARIANTS);
+	trash->rotSpeed[i] = randomRangeReal(RANDOM_STREAM_TRASH, TRASH_MIN_ROT_SPEED, TRASH_MAX_ROT_SPEED);
+	trash->rot[i] = 0;
+	trash->framesLeftAlive[i] = TRASH_LIFETIME;
+	trash->grabbed[i] = false;
+	trash->trashAnimation[i] = false;
+	trash->wasThrown[i] = false;
+	trash->disposal[i] = NO_ENTITY;
+
+	// Physics
+	if (randomRange(RANDOM_STREAM_TRASH, 0, 2)) { // Left/right of the screen
+		trash->x[i] = randomRange(RANDOM_STREAM_TRASH, 0, 2) ? gWorld->view.x - TRASH_SPAWN_DISTANCE : gWorld->view.x + gWorld->view.w + TRASH_SPAWN_DISTANCE;
+		trash->y[i] = randomRangeReal(RANDOM_STREAM_TRASH, gWorld->view.y, gWorld->view.y + gWorld->view.h);
+	} else { // Top/bottom of the screen
+		trash->x[i] = randomRangeReal(RANDOM_STREAM_TRASH, gWorld->view.x, gWorld->view.x + gWorld->view.w);
+		trash->y[i] = randomRange(RANDOM_STREAM_TRASH, 0, 2) ? gWorld->view.y - TRASH_SPAWN_DISTANCE : gWorld->view.y + gWorld->view.h + TRASH_SPAWN_DISTANCE;
+	}
+	real angle = simPointAngle(gWorld->player.physics.x, gWorld->player.physics.y, trash->x[i], trash->y[i]);// - (SIM_PI / 2);
+	real direction = randomRangeReal(RANDOM_STREAM_TRASH, angle - TRASH_PLAYER_DIRECTION_ACCURACY, angle + TRASH_PLAYER_DIRECTION_ACCURACY);
+	Vector velocity = vectorFromAngle(randomRangeReal(RANDOM_STREAM_TRASH, TRASH_MIN_VELOCITY, TRASH_MAX_VELOCITY), direction);
+	trash->vx[i] = velocity.x;
+	trash->vy[i] = velocity.y;
+}
+
+bool trashUpdate(int i, SimCommandBuffer *commands) {
+	TrashPool *trash = &gWorld->population.trash;
+	bool alive = true;
+
+	// Updating, only trash the player has thrown feels gravity
+	if (!trash->grabbed[i]) {
+		FieldSample field;
+		if (trash->wasThrown[i] && fieldSample(&gWorld->field, trash->x[i], trash->y[i], &field)) {
+			if (field.swallowedBy != -1 && !trash->trashAnimation[i]) {
+				// Start the garbage spin animation
+				trash->trashAnimation[i] = true;
+				trash->disposal[i] = fieldAttractor(&gWorld->field, field.swallowedBy)->owner;
+				simCommandPush(commands, SIM_COMMAND_DISPOSE, i, 0);
+				trash->framesLeftAlive[i] = TRASH_FADE_OUT_TIME;
+				trash->vx[i] = 0;
+				trash->vy[i] = 0;
+			} else if (field.swallowedBy == -1 && field.pulled) {
+				physicsAccelerate(&trash->vx[i], &trash->vy[i], field.acceleration.x, field.acceleration.y);
+				trash->lethal[i] = false;
+			}
+		}
+		trash->rot[i] += trash->rotSpeed[i];
+		trash->framesLeftAlive[i] -= 1;
+		alive = trash->framesLeftAlive[i] > 0; // carted
+	} else {
+		trash->framesLeftAlive[i] = TRASH_LIFETIME;
+	}
+
+	// If the trash is in the dying animation just spin out in the garbage disposal
+	int disposal = trash->trashAnimation[i] ? popResolve(trash->disposal[i], ENTITY_TYPE_GARBAGE_DISPOSAL) : -1;
+	if (disposal != -1) {
+		trash->x[i] = gWorld->population.disposals.x[disposal];
+		trash->y[i] = gWorld->population.disposals.y[disposal];
+	}
+
+	// Trash the player never touched can't be pulled or hit anything, so once it's far enough away it can sleep
+	if (alive && gWorld->lod && !trash->grabbed[i] && !trash->trashAnimation[i] && !trash->wasThrown[i]) {
+		real dx = trash->x[i] - gWorld->player.physics.x;
+		real dy = trash->y[i] - gWorld->player.physics.y;
+		real sleepRadius = TRASH_AWAKE_RADIUS + TRASH_SLEEP_MARGIN;
+		if ((dx * dx) + (dy * dy) > sleepRadius * sleepRadius)
+			simCommandPush(commands, SIM_COMMAND_SLEEP, i, 0);
+	}
+	return alive;
+}
+
+void trashAdvanceSleeping(SleepingTrash *sleeping, long tick) {
+	// Stepping clamps to the world every tick but the velocity never changes, so clamping once at the end lands in the same place
+	long ticks = tick - sleeping->sleepTick;
+	sleeping->x = simClamp(sleeping->x + (sleeping->vx * ticks), 0, WORLD_MAX_WIDTH);
+	sleeping->y = simClamp(sleeping->y + (sleeping->vy * ticks), 0, WORLD_MAX_HEIGHT);
+	sleeping->rot += sleeping->rotSpeed * ticks;
+	sleeping->framesLeftAlive -= ticks;
+	sleeping->sleepTick = tick;
+}
+
+// Soonest the sleeping trash needs looking at again, it and the player can't close the distance any faster than both their top speeds
+static long trashWakeTick(SleepingTrash *sleeping) {
+	real dx = sleeping->x - gWorld->player.physics.x;
+	real dy = sleeping->y - gWorld->player.physics.y;
+	real closingSpeed = PHYSICS_BASE_TOP_SPEED + sqrt((sleeping->vx * sleeping->vx) + (sleeping->vy * sleeping->vy));
+	long wakeTick = sleeping->sleepTick + (long)floor((sqrt((dx * dx) + (dy * dy)) - TRASH_AWAKE_RADIUS) / closingSpeed);
+	wakeTick = wakeTick > gWorld->ticks ? wakeTick : gWorld->ticks + 1;
+	long expireTick = sleeping->sleepTick + sleeping->framesLeftAlive;
+	return wakeTick < expireTick ? wakeTick : expireTick;
+}
+
+/********************* Drone functions *********************/
+void droneStart(int i) {
+	DronePool *drones = &gWorld->population.drones;
+	gWorld->enemyCount++;
+	drones->fighter[i] = randomReal(RANDOM_STREAM_FIGHTER) < DRONE_FIGHTER_CHANCE;
+
+	// Spawn off screen
+	if (randomRange(RANDOM_STREAM_DRONE, 0, 2)) { // Left/right of the screen
+		drones->x[i] = randomRange(RANDOM_STREAM_DRONE, 0, 2) ? gWorld->view.x - DRONE_SPAWN_DISTANCE : gWorld->view.x + gWorld->view.w + DRONE_SPAWN_DISTANCE;
+		drones->y[i] = randomRangeReal(RANDOM_STREAM_DRONE, gWorld->view.y, gWorld->view.y + gWorld->view.h);
+	} else { // Top/bottom of the screen
+		drones->x[i] = randomRangeReal(RANDOM_STREAM_DRONE, gWorld->view.x, gWorld->view.x + gWorld->view.w);
+		drones->y[i] = randomRange(RANDOM_STREAM_DRONE, 0, 2) ? gWorld->view.y - DRONE_SPAWN_DISTANCE : gWorld->view.y + gWorld->view.h + DRONE_SPAWN_DISTANCE;
+	}
+}
+
+void droneEnd(int i) {
+	gWorld->population.drones.dying[i] = true;
+	gWorld->population.drones.dyingTimer[i] = DRONE_DYING_TIMER;
+	gWorld->enemyCount--;
+}
+
+bool droneUpdate(int i) {
+	DronePool *drones = &gWorld->population.drones;
+	if (!drones->dying[i]) {
+		// Accelerate towards the player
+		real dx = gWorld->player.physics.x - drones->x[i];
+		real dy = gWorld->player.physics.y - drones->y[i];
+		real dist = sqrt((dx * dx) + (dy * dy));
+		if (dist > 0) {
+			dx /= dist;
+			dy /= dist;
+		}
+		if (!drones->fighter[i]) {
+			physicsAccelerate(&drones->vx[i], &drones->vy[i], dx * DRONE_BASE_ACCELERATION, dy * DRONE_BASE_ACCELERATION);
+		} else {
+			// Fighters fly straight at the player outside of the physics
+			drones->x[i] += dx * PHYSICS_BASE_TOP_SPEED * 0.75;
+			drones->y[i] += dy * PHYSICS_BASE_TOP_SPEED * 0.75;
+		}
+		return true;
+	} else {
+		// Dying animation
+		drones->dyingTimer[i] -= 1;
+		drones->dyingRotation[i] += DRONE_DYING_ROTATE_SPEED;
+
+		// Delete drone when animation is done
+		return drones->dyingTimer[i] > 0;
+	}
+}
+
+/********************* Garbage disposal functions *********************/
+void garbageDisposalStart(int i) {
+	DisposalPool *disposals = &gWorld->population.disposals;
+	disposals->x[i] = GARBAGE_DISPOSAL_START_X;
+	disposals->y[i] = GARBAGE_DISPOSAL_START_Y;
+	disposals->gravityRadius[i] = GARBAGE_DISPOSAL_GRAVITY_RADIUS;
+	disposals->gravity[i] = GARBAGE_DISPOSAL_GRAVITY;
+	disposals->grabRadius[i] = GARBAGE_DISPOSAL_GRAB_RADIUS;
+}
+
+// Makes every garbage disposal an attractor, the field only rebuilds its grid if one of them changed
+static void garbageDisposalsAttract() {
+	DisposalPool *disposals = &gWorld->population.disposals;
+	fieldClear(&gWorld->field);
+	for (int i = 0; i < disposals->count; i++) {
+		FieldAttractor attractor = {disposals->x[i], disposals->y[i], disposals->gravityRadius[i], disposals->gravity[i],
+									disposals->grabRadius[i], popHandle(ENTITY_TYPE_GARBAGE_DISPOSAL, i)};
+		fieldAdd(&gWorld->field, &attractor);
+	}
+	fieldBuild(&gWorld->field);
+}
+
+/********************* Population functions *********************/
+// One array of a pool, lets growing and removing be written once for every pool
+typedef struct {
+	void **array;
+	size_t size;
+} PoolColumn;
+
+#define POOL_COLUMN(field) {(void**)&(field), sizeof(*(field))}
+#define POOL_MAX_COLUMNS 24
+
+// Fills out the columns of the pool for type and returns the pool's count/capacity
+static int popPoolColumns(entitytype type, PoolColumn *columns, int **count, int **capacity) {
+	if (type == ENTITY_TYPE_TRASH) {
+		TrashPool *p = &gWorld->population.trash;
+		PoolColumn c[] = {POOL_COLUMN(p->slot), POOL_COLUMN(p->x), POOL_COLUMN(p->y), POOL_COLUMN(p->lastX), POOL_COLUMN(p->lastY),
+						  POOL_COLUMN(p->vx), POOL_COLUMN(p->vy), POOL_COLUMN(p->framesLeftAlive), POOL_COLUMN(p->rot), POOL_COLUMN(p->rotSpeed),
+						  POOL_COLUMN(p->variant), POOL_COLUMN(p->grabbed), POOL_COLUMN(p->trashAnimation),
+						  POOL_COLUMN(p->wasThrown), POOL_COLUMN(p->lethal), POOL_COLUMN(p->disposal)};
+		memcpy(columns, c, sizeof(c));
+		*count = &p->count;
+		*capacity = &p->capacity;
+		return sizeof(c) / sizeof(PoolColumn);
+	} else if (type == ENTITY_TYPE_DRONE) {
+		DronePool *p = &gWorld->population.drones;
+		PoolColumn c[] = {POOL_COLUMN(p->slot), POOL_COLUMN(p->x), POOL_COLUMN(p->y), POOL_COLUMN(p->lastX), POOL_COLUMN(p->lastY),
+						  POOL_COLUMN(p->vx), POOL_COLUMN(p->vy), POOL_COLUMN(p->dying), POOL_COLUMN(p->dyingTimer), POOL_COLUMN(p->dyingRotation),
+						  POOL_COLUMN(p->fighter)};
+		memcpy(columns, c, sizeof(c));
+		*count = &p->count;
+		*capacity = &p->capacity;
+		return sizeof(c) / sizeof(PoolColumn);
+	} else if (type == ENTITY_TYPE_GARBAGE_DISPOSAL) {
+		DisposalPool *p = &gWorld->population.disposals;
+		PoolColumn c[] = {POOL_COLUMN(p->slot), POOL_COLUMN(p->x), POOL_COLUMN(p->y), POOL_COLUMN(p->gravityRadius), POOL_COLUMN(p->gravity),
+						  POOL_COLUMN(p->grabRadius)};
+		memcpy(columns, c, sizeof(c));
+		*count = &p->count;
+		*capacity = &p->capacity;
+		return sizeof(c) / sizeof(PoolColumn);
+	}
+	return 0;
+}
+
+static int *popPoolSlots(entitytype type) {
+	if (type == ENTITY_TYPE_TRASH)
+		return gWorld->population.trash.slot;
+	else if (type == ENTITY_TYPE_DRONE)
+		return gWorld->population.drones.slot;
+	return gWorld->population.disposals.slot;
+}
+
+/********************* Sleeping trash heap *********************/
+static void sleepingSwap(SleepingTrash *a, SleepingTrash *b) {
+	SleepingTrash t = *a;
+	*a = *b;
+	*b = t;
+}
+
+static void sleepingPush(SleepingTrashHeap *heap, SleepingTrash *sleeping) {
+	if (heap->count == heap->capacity) {
+		heap->capacity = heap->capacity == 0 ? POPULATION_MIN_CAPACITY : heap->capacity * 2;
+		heap->items = realloc(heap->items, heap->capacity * sizeof(SleepingTrash));
+	}
+	int i = heap->count++;
+	heap->items[i] = *sleeping;
+	for (; i > 0 && heap->items[(i - 1) / 2].wakeTick > heap->items[i].wakeTick; i = (i - 1) / 2)
+		sleepingSwap(&heap->items[(i - 1) / 2], &heap->items[i]);
+}
+
+static SleepingTrash sleepingPop(SleepingTrashHeap *heap) {
+	SleepingTrash top = heap->items[0];
+	heap->items[0] = heap->items[--heap->count];
+	for (int i = 0;;) {
+		int smallest = i;
+		int left = (i * 2) + 1;
+		int right = left + 1;
+		if (left < heap->count && heap->items[left].wakeTick < heap->items[smallest].wakeTick)
+			smallest = left;
+		if (right < heap->count && heap->items[right].wakeTick < heap->items[smallest].wakeTick)
+			smallest = right;
+		if (smallest == i)
+			break;
+		sleepingSwap(&heap->items[i], &heap->items[smallest]);
+		i = smallest;
+	}
+	return top;
+}
+
+void simCommandPush(SimCommandBuffer *buffer, simcommand type, int a, int b) {
+	if (buffer->count == buffer->capacity) {
+		buffer->capacity = buffer->capacity == 0 ? 16 : buffer->capacity * 2;
+		buffer->commands = realloc(buffer->commands, buffer->capacity * sizeof(SimCommand));
+	}
+	SimCommand *command = &buffer->commands[buffer->count++];
+	command->type = type;
+	command->a = a;
+	command->b = b;
+}
+
+// Makes sure there is an empty buffer for every chunk of a pass over count things
+static void simCommandsReset(int count) {
+	int chunks = jobsChunkCount(count, SIM_CHUNK_SIZE);
+	if (chunks > gWorld->commandBufferCount) {
+		gWorld->commandBuffers = realloc(gWorld->commandBuffers, chunks * sizeof(SimCommandBuffer));
+		memset(gWorld->commandBuffers + gWorld->commandBufferCount, 0, (chunks - gWorld->commandBufferCount) * sizeof(SimCommandBuffer));
+		gWorld->commandBufferCount = chunks;
+	}
+	for (int i = 0; i < chunks; i++)
+		gWorld->commandBuffers[i].count = 0;
+}
+
+static void simCommandsFree() {
+	for (int i = 0; i < gWorld->commandBufferCount; i++)
+		free(gWorld->commandBuffers[i].commands);
+	free(gWorld->commandBuffers);
+	gWorld->commandBuffers = NULL;
+	gWorld->commandBufferCount = 0;
+}
+
+void popInit() {
+	memset(&gWorld->population, 0, sizeof(Population));
+}
+
+// Doubles the number of slots
+static void popGrowSlots() {
+	int newSize = gWorld->population.size == 0 ? POPULATION_MIN_CAPACITY : gWorld->population.size * 2;
+	gWorld->population.slots = realloc(gWorld->population.slots, newSize * sizeof(PopulationSlot));
+	gWorld->population.freeSlots = realloc(gWorld->population.freeSlots, newSize * sizeof(int));
+
+	// Pushed backwards so the lowest slots get handed out first
+	for (int i = newSize - 1; i >= gWorld->population.size; i--) {
+		gWorld->population.slots[i].type = ENTITY_TYPE_NONE;
+		gWorld->population.slots[i].index = -1;
+		gWorld->population.slots[i].generation = 0;
+		gWorld->population.freeSlots[gWorld->population.freeCount++] = i;
+	}
+	gWorld->population.size = newSize;
+}
+
+int popSpawn(entitytype type, EntityHandle *handle) {
+	PoolColumn columns[POOL_MAX_COLUMNS];
+	int *count, *capacity;
+	int columnCount = popPoolColumns(type, columns, &count, &capacity);
+
+	// Pools double in size when they fill up, which moves all of their arrays
+	if (*count == *capacity) {
+		*capacity = *capacity == 0 ? POPULATION_MIN_CAPACITY : *capacity * 2;
+		for (int i = 0; i < columnCount; i++)
+			*columns[i].array = realloc(*columns[i].array, *capacity * columns[i].size);
+	}
+	int index = (*count)++;
+	for (int i = 0; i < columnCount; i++)
+		memset((char*)*columns[i].array + (index * columns[i].size), 0, columns[i].size);
+
+	// Claim a slot so handles can find the entity wherever it moves in the pool
+	if (gWorld->population.freeCount == 0)
+		popGrowSlots();
+	int slot = gWorld->population.freeSlots[--gWorld->population.freeCount];
+	gWorld->population.slots[slot].type = type;
+	gWorld->population.slots[slot].index = index;
+	popPoolSlots(type)[index] = slot;
+
+	if (handle != NULL)
+		*handle = popHandle(type, index);
+	return index;
+}
+
+void popRemove(entitytype type, int index) {
+	PoolColumn columns[POOL_MAX_COLUMNS];
+	int *count, *capacity;
+	int columnCount = popPoolColumns(type, columns, &count, &capacity);
+	int *slots = popPoolSlots(type);
+	int last = *count - 1;
+
+	// Free the slot so any handles to it stop resolving
+	int slot = slots[index];
+	gWorld->population.slots[slot].type = ENTITY_TYPE_NONE;
+	gWorld->population.slots[slot].index = -1;
+	gWorld->population.slots[slot].generation++;
+	gWorld->population.freeSlots[gWorld->population.freeCount++] = slot;
+
+	// Move the last entity into the hole to keep the pool packed
+	if (index != last) {
+		for (int i = 0; i < columnCount; i++)
+			memcpy((char*)*columns[i].array + (index * columns[i].size), (char*)*columns[i].array + (last * columns[i].size), columns[i].size);
+		gWorld->population.slots[slots[index]].index = index;
+	}
+	(*count)--;
+}
+
+// Takes trash out of the pool and puts it to sleep as it is now
+static void popSleepTrash(int i) {
+	TrashPool *trash = &gWorld->population.trash;
+	SleepingTrash sleeping = {0, gWorld->ticks, trash->x[i], trash->y[i], trash->vx[i], trash->vy[i], trash->rot[i], trash->rotSpeed[i],
+							  trash->framesLeftAlive[i], trash->variant[i]};
+	sleeping.wakeTick = trashWakeTick(&sleeping);
+	sleepingPush(&gWorld->population.sleepingTrash, &sleeping);
+	popRemove(ENTITY_TYPE_TRASH, i);
+}
+
+// Checks on sleeping trash that's due, what's close to the player again goes back into the pool for this tick's update
+static void popWakeTrash() {
+	SleepingTrashHeap *heap = &gWorld->population.sleepingTrash;
+	TrashPool *trash = &gWorld->population.trash;
+	while (heap->count > 0 && heap->items[0].wakeTick <= gWorld->ticks) {
+		SleepingTrash sleeping = sleepingPop(heap);
+
+		// Caught up to the end of last tick, anything with one frame left would run out this tick
+		trashAdvanceSleeping(&sleeping, gWorld->ticks - 1);
+		if (sleeping.framesLeftAlive <= 1)
+			continue;
+		real dx = sleeping.x - gWorld->player.physics.x;
+		real dy = sleeping.y - gWorld->player.physics.y;
+		real sleepRadius = TRASH_AWAKE_RADIUS + TRASH_SLEEP_MARGIN;
+		if (gWorld->lod && (dx * dx) + (dy * dy) > sleepRadius * sleepRadius) {
+			sleeping.wakeTick = trashWakeTick(&sleeping);
+			sleepingPush(heap, &sleeping);
+			continue;
+		}
+
+		int i = popSpawn(ENTITY_TYPE_TRASH, NULL);
+		trash->x[i] = trash->lastX[i] = sleeping.x;
+		trash->y[i] = trash->lastY[i] = sleeping.y;
+		trash->vx[i] = sleeping.vx;
+		trash->vy[i] = sleeping.vy;
+		trash->rot[i] = sleeping.rot;
+		trash->rotSpeed[i] = sleeping.rotSpeed;
+		trash->framesLeftAlive[i] = sleeping.framesLeftAlive;
+		trash->variant[i] = sleeping.variant;
+	}
+}
+
+// Updates then moves a chunk of trash, runs on any thread so it's given the world to work on
+static void popUpdateTrashChunk(int chunk, int begin, int end, int worker, void *data) {
+	gWorld = data;
+	TrashPool *trash = &gWorld->population.trash;
+	for (int i = begin; i < end; i++)
+		if (!trashUpdate(i, &gWorld->commandBuffers[chunk]))
+			simCommandPush(&gWorld->commandBuffers[chunk], SIM_COMMAND_REMOVE, i, 0);
+	physicsIntegrate(trash->x + begin, trash->y + begin, trash->vx + begin, trash->vy + begin, end - begin);
+}
+
+static void popUpdateDroneChunk(int chunk, int begin, int end, int worker, void *data) {
+	gWorld = data;
+	DronePool *drones = &gWorld->population.drones;
+	for (int i = begin; i < end; i++)
+		if (!droneUpdate(i))
+			simCommandPush(&gWorld->commandBuffers[chunk], SIM_COMMAND_REMOVE, i, 0);
+	physicsIntegrate(drones->x + begin, drones->y + begin, drones->vx + begin, drones->vy + begin, end - begin);
+}
+
+// Applies the commands from a pass over count entities of type
+static void popApplyCommands(entitytype type, int count) {
+	int chunks = jobsChunkCount(count, SIM_CHUNK_SIZE);
+	for (int chunk = 0; chunk < chunks; chunk++) {
+		SimCommandBuffer *buffer = &gWorld->commandBuffers[chunk];
+		for (int i = 0; i < buffer->count; i++)
+			if (buffer->commands[i].type == SIM_COMMAND_DISPOSE) {
+				gWorld->score += randomRangeReal(RANDOM_STREAM_SCORE, TRASH_MIN_VALUE, TRASH_MAX_VALUE);
+				gWorld->trashDisposed++;
+			}
+	}
+
+	// Highest index first so whatever gets swapped into a removed spot is always alive
+	for (int chunk = chunks - 1; chunk >= 0; chunk--) {
+		SimCommandBuffer *buffer = &gWorld->commandBuffers[chunk];
+		for (int i = buffer->count - 1; i >= 0; i--) {
+			if (buffer->commands[i].type == SIM_COMMAND_REMOVE)
+				popRemove(type, buffer->commands[i].a);
+			else if (buffer->commands[i].type == SIM_COMMAND_SLEEP)
+				popSleepTrash(buffer->commands[i].a);
+		}
+	}
+}
+
+void popUpdateEntities() {
+	// Each type gets its own pass over its pool in parallel, entities that are done get removed after
+	popWakeTrash();
+	int count = gWorld->population.trash.count;
+	simCommandsReset(count);
+	jobsParallelFor(count, SIM_CHUNK_SIZE, popUpdateTrashChunk, gWorld);
+	popApplyCommands(ENTITY_TYPE_TRASH, count);
+
+	count = gWorld->population.drones.count;
+	simCommandsReset(count);
+	jobsParallelFor(count, SIM_CHUNK_SIZE, popUpdateDroneChunk, gWorld);
+	popApplyCommands(ENTITY_TYPE_DRONE, count);
+}
+
+// Thrown trash knocks out any drone it hits
+static bool popCollideDroneTrash(int droneIndex, int trashIndex, real distance, void *data) {
+	TrashPool *trash = &gWorld->population.trash;
+	DronePool *drones = &gWorld->population.drones;
+	if (drones->dying[droneIndex] || !trash->lethal[trashIndex])
+		return true;
+
+	// Lethal trash is always going exactly PLAYER_BASE_TRASH_THROW_SPEED so it can be rescaled without a sqrt
+	droneEnd(droneIndex);
+	gWorld->kills++;
+	drones->vx[droneIndex] = trash->vx[trashIndex] * (DRONE_DYING_SPEED / PLAYER_BASE_TRASH_THROW_SPEED);
+	drones->vy[droneIndex] = trash->vy[trashIndex] * (DRONE_DYING_SPEED / PLAYER_BASE_TRASH_THROW_SPEED);
+	trash->vx[trashIndex] /= 2;
+	trash->vy[trashIndex] /= 2;
+	trash->lethal[trashIndex] = false;
+	return true;
+}
+
+// Finds which drones in a chunk of gWorld->spatial are touching lethal trash, runs on any thread
+static bool popFindDroneTrash(int droneIndex, int trashIndex, real distance, void *data) {
+	// Hits only ever turn these off so anything that fails now would fail when applied too
+	if (!gWorld->population.drones.dying[droneIndex] && gWorld->population.trash.lethal[trashIndex])
+		simCommandPush(data, SIM_COMMAND_DRONE_HIT, droneIndex, trashIndex);
+	return true;
+}
+
+static void popFindDroneTrashChunk(int chunk, int begin, int end, int worker, void *data) {
+	gWorld = data;
+	spatialForEachPairRange(&gWorld->spatial, DRONE_TRASH_COLLISION_DISTANCE, SPATIAL_MASK(ENTITY_TYPE_DRONE), SPATIAL_MASK(ENTITY_TYPE_TRASH),
+							begin, end, popFindDroneTrash, &gWorld->commandBuffers[chunk]);
+}
+
+// Drones that reach the player hurt them and bounce off
+static bool popCollideDronePlayer(int index, real distance, void *data) {
+	DronePool *drones = &gWorld->population.drones;
+	if (!drones->dying[index]) {
+		Vector velocity = {drones->vx[index], drones->vy[index]};
+		playerTakeDamage(&velocity);
+		drones->vx[index] *= -0.5;
+		drones->vy[index] *= -0.5;
+	}
+	return true;
+}
+
+// Handles every interaction between entities, gWorld->spatial must be up to date
+void popCollideEntities() {
+	// There are far fewer drones than trash so trash gets looked up around drones
+	// Looking for hits is split across threads, they're applied in order after
+	simCommandsReset(gWorld->spatial.count);
+	jobsParallelFor(gWorld->spatial.count, SIM_CHUNK_SIZE, popFindDroneTrashChunk, gWorld);
+	for (int chunk = 0; chunk < jobsChunkCount(gWorld->spatial.count, SIM_CHUNK_SIZE); chunk++) {
+		SimCommandBuffer *buffer = &gWorld->commandBuffers[chunk];
+		for (int i = 0; i < buffer->count; i++)
+			popCollideDroneTrash(buffer->commands[i].a, buffer->commands[i].b, 0, NULL);
+	}
+	spatialQueryRadius(&gWorld->spatial, gWorld->player.physics.x, gWorld->player.physics.y, DRONE_DAMAGE_RADIUS, SPATIAL_MASK(ENTITY_TYPE_DRONE), popCollideDronePlayer, NULL);
+}
+
+void popEnd() {
+	entitytype types[] = {ENTITY_TYPE_TRASH, ENTITY_TYPE_DRONE, ENTITY_TYPE_GARBAGE_DISPOSAL};
+	for (int t = 0; t < sizeof(types) / sizeof(entitytype); t++) {
+		PoolColumn columns[POOL_MAX_COLUMNS];
+		int *count, *capacity;
+		int columnCount = popPoolColumns(types[t], columns, &count, &capacity);
+		for (int i = 0; i < columnCount; i++)
+			free(*columns[i].array);
+	}
+	free(gWorld->population.slots);
+	free(gWorld->population.freeSlots);
+	free(gWorld->population.sleepingTrash.items);
+	popInit();
+}
+
+EntityHandle popHandle(entitytype type, int index) {
+	int slot = popPoolSlots(type)[index];
+	EntityHandle handle = {slot, gWorld->population.slots[slot].generation};
+	return handle;
+}
+
+int popResolve(EntityHandle handle, entitytype type) {
+	if (handle.index < 0 || handle.index >= gWorld->population.size)
+		return -1;
+	PopulationSlot *slot = &gWorld->population.slots[handle.index];
+	if (slot->generation != handle.generation || slot->type != type)
+		return -1;
+	return slot->index;
+}
+
+/********************* Player functions *********************/
+void playerStart() {
+	memset(&gWorld->player, 0, sizeof(PlayerEntity));
+	physicsStart(&gWorld->player.physics, PLAYER_START_X, PLAYER_START_Y);
+	gWorld->player.player.grabbedTrash = NO_ENTITY;
+	gWorld->player.player.hp = PLAYER_BASE_HP;
+}
+
+// Trash that's already on its way into the disposal can't be taken back out
+static bool playerCanGrab(int index, entitytype type, void *data) {
+	return index < gWorld->population.trash.count && !gWorld->population.trash.grabbed[index] && !gWorld->population.trash.trashAnimation[index];
+}
+
+// gWorld->spatial is still from the end of the last tick here, nothing has moved or been removed since
+void playerUpdate(const PlayerInput *input) {
+	if (gWorld->player.player.hp > 0) {
+		// Rotate the ship
+		if (input->left || input->right) {
+			gWorld->player.player.dirVelocity +=
+					(-((real) input->left) + ((real) input->right)) *
+					PLAYER_BASE_ROTATE_ACCELERATION;
+		} else {
+			if (simSign(gWorld->player.player.dirVelocity - simSign(gWorld->player.player.dirVelocity) * PLAYER_BASE_ROTATE_FRICTION) !=
+				simSign(gWorld->player.player.dirVelocity))
+				gWorld->player.player.dirVelocity = 0;
+			else
+				gWorld->player.player.dirVelocity -= simSign(gWorld->player.player.dirVelocity) * PLAYER_BASE_ROTATE_FRICTION;
+		}
+		gWorld->player.player.dirVelocity = simClamp(gWorld->player.player.dirVelocity, -PLAYER_BASE_ROTATE_TOP_SPEED,
+											  PLAYER_BASE_ROTATE_TOP_SPEED);
+		gWorld->player.player.direction += gWorld->player.player.dirVelocity;
+
+		// Calculate acceleration vector, friction comes to a dead stop instead of overshooting
+		Vector acceleration = {};
+		if (input->thrust) {
+			acceleration = vectorFromAngle(PLAYER_BASE_ACCELERATION, gWorld->player.player.direction);
+		} else {
+			real speed = sqrt((gWorld->player.physics.velocity.x * gWorld->player.physics.velocity.x) + (gWorld->player.physics.velocity.y * gWorld->player.physics.velocity.y));
+			real friction = speed > PLAYER_FRICTION ? PLAYER_FRICTION / speed : 1;
+			acceleration.x = -gWorld->player.physics.velocity.x * friction;
+			acceleration.y = -gWorld->player.physics.velocity.y * friction;
+		}
+
+		// Check if the player grabs the closest trash, a grabbed trash that no longer exists is simply let go
+		TrashPool *trash = &gWorld->population.trash;
+		int grabbed = popResolve(gWorld->player.player.grabbedTrash, ENTITY_TYPE_TRASH);
+		int i;
+		if (input->grabPressed && grabbed == -1 &&
+			spatialQueryNearest(&gWorld->spatial, gWorld->player.physics.x, gWorld->player.physics.y, PLAYER_BASE_TRASH_GRAB_DISTANCE,
+								SPATIAL_MASK(ENTITY_TYPE_TRASH), playerCanGrab, NULL, 1, &i, NULL) == 1) {
+			grabbed = i;
+			trash->grabbed[i] = true;
+			trash->lethal[i] = false;
+			trash->vx[i] = 0;
+			trash->vy[i] = 0;
+			gWorld->player.player.grabbedTrash = popHandle(ENTITY_TYPE_TRASH, i);
+		} else if (input->grabReleased && grabbed != -1) {
+			Vector velocity = vectorFromAngle(PLAYER_BASE_TRASH_THROW_SPEED, gWorld->player.player.direction);
+			trash->vx[grabbed] = velocity.x;
+			trash->vy[grabbed] = velocity.y;
+			trash->wasThrown[grabbed] = true;
+			trash->lethal[grabbed] = true;
+			trash->grabbed[grabbed] = false;
+			grabbed = -1;
+		}
+		if (grabbed == -1)
+			gWorld->player.player.grabbedTrash = NO_ENTITY;
+
+		// Do stuff with grabbed trash
+		if (grabbed != -1) {
+			Vector offset = vectorFromAngle(PLAYER_TRASH_DRAW_DISTANCE, gWorld->player.player.direction);
+			trash->x[grabbed] = gWorld->player.physics.x + offset.x;
+			trash->y[grabbed] = gWorld->player.physics.y + offset.y;
+		}
+
+		// IFrames
+		if (gWorld->player.player.iframes > 0)
+			gWorld->player.player.iframes -= 1;
+
+		physicsUpdate(&gWorld->player.physics, &acceleration);
+	} else {
+		// Dying animation
+		gWorld->player.player.direction += PLAYER_DYING_ROTATE_SPEED;
+		physicsUpdate(&gWorld->player.physics, NULL);
+	}
+}
+
+void playerEnd() {
+
+}
+
+// The player gets knocked along velocity
+void playerTakeDamage(Vector *velocity) {
+	if (gWorld->player.player.hp > 0 && gWorld->player.player.iframes <= 0) {
+		gWorld->player.player.hp -= 1;
+		gWorld->player.player.iframes = PLAYER_DAMAGED_IFRAMES;
+		gWorld->player.physics.velocity = *velocity;
+	}
+}
+
+PlayerInput simScriptedInput(long tick) {
+	PlayerInput input = {};
+	input.thrust = (tick / 120) % 3 != 0;
+	input.right = (tick / 200) % 2 == 0;
+	input.grabPressed = tick % 60 == 0;
+	input.grabReleased = tick % 60 == 30;
+	return input;
+}
+
+/********************* Simulation functions *********************/
+// FNV-1a over raw bytes, reals are hashed by their bits since replays are checked on the same build
+static uint64_t simHashBytes(uint64_t hash, const void *data, size_t size) {
+	const unsigned char *bytes = data;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	return hash;
+}
+
+// Remembers where everything is before it moves so drawing can blend between ticks
+static void simSaveLast() {
+	TrashPool *trash = &gWorld->population.trash;
+	DronePool *drones = &gWorld->population.drones;
+	memcpy(trash->lastX, trash->x, trash->count * sizeof(real));
+	memcpy(trash->lastY, trash->y, trash->count * sizeof(real));
+	memcpy(drones->lastX, drones->x, drones->count * sizeof(real));
+	memcpy(drones->lastY, drones->y, drones->count * sizeof(real));
+	gWorld->player.physics.lastX = gWorld->player.physics.x;
+	gWorld->player.physics.lastY = gWorld->player.physics.y;
+	gWorld->lastView = gWorld->view;
+}
+
+void simStart(uint64_t seed, SimView view) {
+	randomSeed(seed);
+	popInit();
+	playerStart();
+	garbageDisposalStart(popSpawn(ENTITY_TYPE_GARBAGE_DISPOSAL, &gWorld->garbageDisposal));
+	gWorld->view = view;
+	gWorld->ticks = 0;
+	gWorld->score = 0;
+	gWorld->kills = 0;
+	gWorld->trashDisposed = 0;
+	gWorld->spawnDelay = 0;
+	gWorld->enemyCount = 0;
+	gWorld->enemyMax = 1;
+	gWorld->lastGarbageTime = 0;
+	gWorld->lastEnemyTime = 0;
+	gWorld->enemyCountLastTime = 0;
+	simSaveLast();
+}
+
+void simUpdate(const PlayerInput *input) {
+	// Spawn timers run off of ticks so the game plays the same no matter how fast it's stepped
+	gWorld->ticks++;
+	real time = gWorld->ticks / FPS_LIMIT;
+	if (time - gWorld->lastGarbageTime >= TRASH_SPAWN_INTERVAL) {
+		gWorld->lastGarbageTime = time;
+		trashStart(popSpawn(ENTITY_TYPE_TRASH, NULL));
+	}
+
+	// Enemy spawning
+	if (gWorld->spawnDelay >= DRONE_SPAWN_DELAY) {
+		if (time - gWorld->lastEnemyTime >= DRONE_SPAWN_INTERVAL) {
+			gWorld->lastEnemyTime = time;
+			if (gWorld->enemyCount < gWorld->enemyMax) {
+				droneStart(popSpawn(ENTITY_TYPE_DRONE, NULL));
+			} else if (time - gWorld->enemyCountLastTime >= DRONE_MAX_INTERVAL) {
+				gWorld->enemyCountLastTime = time;
+				gWorld->enemyMax++;
+			}
+		}
+	} else {
+		gWorld->spawnDelay++;
+		gWorld->lastEnemyTime = time;
+	}
+
+	// Anything spawned this tick starts where it is
+	simSaveLast();
+
+	// Keep the view around the player
+	gWorld->view.x += ((gWorld->player.physics.x - (gWorld->view.w / 2)) - gWorld->view.x) * CAMERA_SPEED;
+	gWorld->view.y += ((gWorld->player.physics.y - (gWorld->view.h / 2)) - gWorld->view.y) * CAMERA_SPEED;
+	gWorld->view.x = simClamp(gWorld->view.x, 0, WORLD_MAX_WIDTH - gWorld->view.w);
+	gWorld->view.y = simClamp(gWorld->view.y, 0, WORLD_MAX_HEIGHT - gWorld->view.h);
+
+	// Update entities then let them interact
+	PROFILE_BEGIN(PROFILE_ZONE_PLAYER);
+	playerUpdate(input);
+	PROFILE_END(PROFILE_ZONE_PLAYER);
+	PROFILE_BEGIN(PROFILE_ZONE_ENTITIES);
+	garbageDisposalsAttract();
+	popUpdateEntities();
+	PROFILE_END(PROFILE_ZONE_ENTITIES);
+	PROFILE_BEGIN(PROFILE_ZONE_SPATIAL);
+	spatialBuildFromPopulation(&gWorld->spatial, &gWorld->population);
+	PROFILE_END(PROFILE_ZONE_SPATIAL);
+	PROFILE_BEGIN(PROFILE_ZONE_COLLISIONS);
+	popCollideEntities();
+	PROFILE_END(PROFILE_ZONE_COLLISIONS);
+}
+
+void simEnd() {
+	popEnd();
+	simCommandsFree();
+	spatialFree(&gWorld->spatial);
+	fieldFree(&gWorld->field);
+	gWorld->garbageDisposal = NO_ENTITY;
+	playerEnd();
+}
+
+/********************* World functions *********************/
+SimWorld *simWorldCreate() {
+	SimWorld *world = calloc(1, sizeof(SimWorld));
+	world->garbageDisposal = NO_ENTITY;
+	world->enemyMax = 1;
+	world->lod = true;
+	return world;
+}
+
+void simWorldFree(SimWorld *world) {
+	SimWorld *current = gWorld;
+	gWorld = world;
+	simEnd();
+	gWorld = current;
+	free(world);
+}
+
+uint64_t simHash() {
+	TrashPool *trash = &gWorld->population.trash;
+	DronePool *drones = &gWorld->population.drones;
+	uint64_t hash = 0xcbf29ce484222325ull;
+	hash = simHashBytes(hash, &gWorld->ticks, sizeof(gWorld->ticks));
+	hash = simHashBytes(hash, &gWorld->score, sizeof(gWorld->score));
+	hash = simHashBytes(hash, &gWorld->enemyCount, sizeof(gWorld->enemyCount));
+	hash = simHashBytes(hash, &gWorld->enemyMax, sizeof(gWorld->enemyMax));
+	hash = simHashBytes(hash, &gWorld->view.x, sizeof(real));
+	hash = simHashBytes(hash, &gWorld->view.y, sizeof(real));
+	hash = simHashBytes(hash, &gWorld->player.physics.x, sizeof(real));
+	hash = simHashBytes(hash, &gWorld->player.physics.y, sizeof(real));
+	hash = simHashBytes(hash, &gWorld->player.physics.velocity, sizeof(Vector));
+	hash = simHashBytes(hash, &gWorld->player.player.direction, sizeof(real));
+	hash = simHashBytes(hash, &gWorld->player.player.hp, sizeof(real));
+	hash = simHashBytes(hash, &gWorld->player.player.iframes, sizeof(int));
+	hash = simHashBytes(hash, &trash->count, sizeof(int));
+	hash = simHashBytes(hash, trash->x, trash->count * sizeof(real));
+	hash = simHashBytes(hash, trash->y, trash->count * sizeof(real));
+	hash = simHashBytes(hash, trash->vx, trash->count * sizeof(real));
+	hash = simHashBytes(hash, trash->vy, trash->count * sizeof(real));
+	hash = simHashBytes(hash, trash->framesLeftAlive, trash->count * sizeof(int));
+	hash = simHashBytes(hash, &gWorld->population.sleepingTrash.count, sizeof(int));
+	hash = simHashBytes(hash, gWorld->population.sleepingTrash.items, gWorld->population.sleepingTrash.count * sizeof(SleepingTrash));
+	hash = simHashBytes(hash, &drones->count, sizeof(int));
+	hash = simHashBytes(hash, drones->x, drones->count * sizeof(real));
+	hash = simHashBytes(hash, drones->y, drones->count * sizeof(real));
+	hash = simHashBytes(hash, drones->vx, drones->count * sizeof(real));
+	hash = simHashBytes(hash, drones->vy, drones->count * sizeof(real));
+	hash = simHashBytes(hash, drones->dyingTimer, drones->count * sizeof(int));
+	return hash;
+}
+
+/********************* Snapshot functions *********************/
+// Everything in the world that isn't in an array, followed in the snapshot by the slots, the free slot
+// stack, every pool a column at a time and the sleeping trash
+typedef struct {
+	PlayerEntity player;
+	EntityHandle garbageDisposal;
+	SimView view;
+	SimView lastView;
+	long ticks;
+	real score;
+	int kills;
+	int trashDisposed;
+	real lastGarbageTime;
+	real lastEnemyTime;
+	int enemyCount;
+	int enemyMax;
+	real enemyCountLastTime;
+	int spawnDelay;
+	RandomStream random[RANDOM_STREAM_MAX];
+	int slotCount;
+	int freeCount;
+	int poolCount[3];
+	int poolCapacity[3];
+	int sleepingCount;
+	int sleepingCapacity;
+	bool lod;
+} SimSnapshotHeader;
+
+static const entitytype SNAPSHOT_POOLS[] = {ENTITY_TYPE_TRASH, ENTITY_TYPE_DRONE, ENTITY_TYPE_GARBAGE_DISPOSAL};
+
+// Planes are filled one at a time, going across all of them at once has every write land capacity bytes apart
+static inline void simSnapshotSplit(uint8_t *out, const uint8_t *bytes, size_t size, int count, int capacity) {
+	for (size_t b = 0; b < size; b++)
+		for (int i = 0; i < count; i++)
+			out[(b * capacity) + i] = bytes[(i * size) + b];
+}
+
+static inline void simSnapshotJoin(const uint8_t *in, uint8_t *bytes, size_t size, int count, int capacity) {
+	for (size_t b = 0; b < size; b++)
+		for (int i = 0; i < count; i++)
+			bytes[(i * size) + b] = in[(b * capacity) + i];
+}
+
+// Writes byte b of every value together, each plane padded with zeros out to capacity values
+static uint8_t *simSnapshotPlanes(uint8_t *out, const void *values, size_t size, int count, int capacity) {
+	// The common sizes get their own copy of the loop so it's unrolled
+	if (size == sizeof(real))
+		simSnapshotSplit(out, values, sizeof(real), count, capacity);
+	else if (size == sizeof(int))
+		simSnapshotSplit(out, values, sizeof(int), count, capacity);
+	else
+		simSnapshotSplit(out, values, size, count, capacity);
+	for (size_t b = 0; b < size; b++)
+		memset(out + (b * capacity) + count, 0, capacity - count);
+	return out + (size * capacity);
+}
+
+static const uint8_t *simSnapshotUnplanes(const uint8_t *in, void *values, size_t size, int count, int capacity) {
+	if (size == sizeof(real))
+		simSnapshotJoin(in, values, sizeof(real), count, capacity);
+	else if (size == sizeof(int))
+		simSnapshotJoin(in, values, sizeof(int), count, capacity);
+	else
+		simSnapshotJoin(in, values, size, count, capacity);
+	return in + (size * capacity);
+}
+
+// Structs are copied as they are, splitting them reads the whole array again for every byte in them
+static uint8_t *simSnapshotCopy(uint8_t *out, const void *values, size_t size, int count, int capacity) {
+	if (count > 0)
+		memcpy(out, values, count * size);
+	memset(out + (count * size), 0, (capacity - count) * size);
+	return out + (size * capacity);
+}
+
+static const uint8_t *simSnapshotUncopy(const uint8_t *in, void *values, size_t size, int count, int capacity) {
+	if (count > 0)
+		memcpy(values, in, count * size);
+	return in + (size * capacity);
+}
+
+// Bytes the arrays after the header take up
+static size_t simSnapshotArraysSize(const SimSnapshotHeader *header) {
+	size_t size = ((size_t)header->slotCount * (sizeof(PopulationSlot) + sizeof(int))) + ((size_t)header->sleepingCapacity * sizeof(SleepingTrash));
+	for (int t = 0; t < sizeof(SNAPSHOT_POOLS) / sizeof(entitytype); t++) {
+		PoolColumn columns[POOL_MAX_COLUMNS];
+		int *count, *capacity;
+		int columnCount = popPoolColumns(SNAPSHOT_POOLS[t], columns, &count, &capacity);
+		for (int i = 0; i < columnCount; i++)
+			size += (size_t)header->poolCapacity[t] * columns[i].size;
+	}
+	return size;
+}
+
+// Resizes an array the snapshot is loading into, realloc to 0 bytes isn't portable
+static void simSnapshotResize(void **array, size_t size) {
+	if (size == 0) {
+		free(*array);
+		*array = NULL;
+	} else {
+		*array = realloc(*array, size);
+	}
+}
+
+size_t simSnapshotSave(uint8_t **buffer, size_t *capacity) {
+	// Zeroed first so padding in the header is the same every time
+	SimSnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	header.player = gWorld->player;
+	header.garbageDisposal = gWorld->garbageDisposal;
+	header.view = gWorld->view;
+	header.lastView = gWorld->lastView;
+	header.ticks = gWorld->ticks;
+	header.score = gWorld->score;
+	header.kills = gWorld->kills;
+	header.trashDisposed = gWorld->trashDisposed;
+	header.lastGarbageTime = gWorld->lastGarbageTime;
+	header.lastEnemyTime = gWorld->lastEnemyTime;
+	header.enemyCount = gWorld->enemyCount;
+	header.enemyMax = gWorld->enemyMax;
+	header.enemyCountLastTime = gWorld->enemyCountLastTime;
+	header.spawnDelay = gWorld->spawnDelay;
+	header.lod = gWorld->lod;
+	memcpy(header.random, gWorld->random, sizeof(gWorld->random));
+	header.slotCount = gWorld->population.size;
+	header.freeCount = gWorld->population.freeCount;
+	for (int t = 0; t < sizeof(SNAPSHOT_POOLS) / sizeof(entitytype); t++) {
+		PoolColumn columns[POOL_MAX_COLUMNS];
+		int *count, *poolCapacity;
+		popPoolColumns(SNAPSHOT_POOLS[t], columns, &count, &poolCapacity);
+		header.poolCount[t] = *count;
+		header.poolCapacity[t] = *poolCapacity;
+	}
+	header.sleepingCount = gWorld->population.sleepingTrash.count;
+	header.sleepingCapacity = gWorld->population.sleepingTrash.capacity;
+
+	size_t size = sizeof(header) + simSnapshotArraysSize(&header);
+	if (size > *capacity) {
+		*capacity = size;
+		*buffer = realloc(*buffer, size);
+	}
+	uint8_t *out = *buffer;
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+	out = simSnapshotCopy(out, gWorld->population.slots, sizeof(PopulationSlot), header.slotCount, header.slotCount);
+	out = simSnapshotCopy(out, gWorld->population.freeSlots, sizeof(int), header.freeCount, header.slotCount);
+	for (int t = 0; t < sizeof(SNAPSHOT_POOLS) / sizeof(entitytype); t++) {
+		PoolColumn columns[POOL_MAX_COLUMNS];
+		int *count, *poolCapacity;
+		int columnCount = popPoolColumns(SNAPSHOT_POOLS[t], columns, &count, &poolCapacity);
+		for (int i = 0; i < columnCount; i++)
+			out = simSnapshotPlanes(out, *columns[i].array, columns[i].size, *count, *poolCapacity);
+	}
+	simSnapshotCopy(out, gWorld->population.sleepingTrash.items, sizeof(SleepingTrash), header.sleepingCount, header.sleepingCapacity);
+	return size;
+}
+
+bool simSnapshotLoad(const uint8_t *data, size_t size) {
+	SimSnapshotHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	bool valid = header.slotCount >= 0 && header.freeCount >= 0 && header.freeCount <= header.slotCount &&
+				 header.sleepingCount >= 0 && header.sleepingCount <= header.sleepingCapacity;
+	for (int t = 0; t < sizeof(SNAPSHOT_POOLS) / sizeof(entitytype); t++)
+		valid = valid && header.poolCount[t] >= 0 && header.poolCount[t] <= header.poolCapacity[t];
+	if (!valid || size != sizeof(header) + simSnapshotArraysSize(&header))
+		return false;
+
+	gWorld->player = header.player;
+	gWorld->garbageDisposal = header.garbageDisposal;
+	gWorld->view = header.view;
+	gWorld->lastView = header.lastView;
+	gWorld->ticks = header.ticks;
+	gWorld->score = header.score;
+	gWorld->kills = header.kills;
+	gWorld->trashDisposed = header.trashDisposed;
+	gWorld->lastGarbageTime = header.lastGarbageTime;
+	gWorld->lastEnemyTime = header.lastEnemyTime;
+	gWorld->enemyCount = header.enemyCount;
+	gWorld->enemyMax = header.enemyMax;
+	gWorld->enemyCountLastTime = header.enemyCountLastTime;
+	gWorld->spawnDelay = header.spawnDelay;
+	gWorld->lod = header.lod;
+	memcpy(gWorld->random, header.random, sizeof(gWorld->random));
+
+	// Arrays are sized exactly as they were so growing them later happens on the same ticks as before
+	const uint8_t *in = data + sizeof(header);
+	gWorld->population.size = header.slotCount;
+	gWorld->population.freeCount = header.freeCount;
+	simSnapshotResize((void**)&gWorld->population.slots, header.slotCount * sizeof(PopulationSlot));
+	simSnapshotResize((void**)&gWorld->population.freeSlots, header.slotCount * sizeof(int));
+	in = simSnapshotUncopy(in, gWorld->population.slots, sizeof(PopulationSlot), header.slotCount, header.slotCount);
+	in = simSnapshotUncopy(in, gWorld->population.freeSlots, sizeof(int), header.freeCount, header.slotCount);
+	for (int t = 0; t < sizeof(SNAPSHOT_POOLS) / sizeof(entitytype); t++) {
+		PoolColumn columns[POOL_MAX_COLUMNS];
+		int *count, *capacity;
+		int columnCount = popPoolColumns(SNAPSHOT_POOLS[t], columns, &count, &capacity);
+		*count = header.poolCount[t];
+		*capacity = header.poolCapacity[t];
+		for (int i = 0; i < columnCount; i++) {
+			simSnapshotResize(columns[i].array, *capacity * columns[i].size);
+			in = simSnapshotUnplanes(in, *columns[i].array, columns[i].size, *count, *capacity);
+		}
+	}
+	SleepingTrashHeap *sleeping = &gWorld->population.sleepingTrash;
+	sleeping->count = header.sleepingCount;
+	sleeping->capacity = header.sleepingCapacity;
+	simSnapshotResize((void**)&sleeping->items, sleeping->capacity * sizeof(SleepingTrash));
+	simSnapshotUncopy(in, sleeping->items, sizeof(SleepingTrash), sleeping->count, sleeping->capacity);
+
+	// The next tick's player update expects gWorld->spatial as it was at the end of this one
+	spatialBuildFromPopulation(&gWorld->spatial, &gWorld->population);
+	return true;
+}
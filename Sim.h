@@ -0,0 +1,353 @@
+// Game simulation, kept free of SDL/VK2D so it can run headless
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+#include "Random.h"
+
+/********************* Types *********************/
+typedef double real;
+typedef enum {
+	ENTITY_TYPE_NONE = 0,
+	ENTITY_TYPE_PLAYER = 1,
+	ENTITY_TYPE_TRASH = 2,
+	ENTITY_TYPE_DRONE = 3,
+	ENTITY_TYPE_MINE = 4,
+	ENTITY_TYPE_GARBAGE_DISPOSAL = 5,
+	ENTITY_TYPE_MAX = 6,
+} entitytype;
+
+// Each source of randomness has its own stream so adding draws to one doesn't shift the others
+typedef enum {
+	RANDOM_STREAM_TRASH = 0,   // Trash spawns
+	RANDOM_STREAM_DRONE = 1,   // Drone spawns
+	RANDOM_STREAM_FIGHTER = 2, // Whether a drone is a fighter
+	RANDOM_STREAM_SCORE = 3,   // Trash value
+	RANDOM_STREAM_MAX = 4,
+} randomstream;
+
+/********************* Constants **********************/
+#define SIM_PI ((real)3.14159265358979323846)
+
+static const real FPS_LIMIT   = 60; // Simulation ticks per second
+static const int  GAME_WIDTH  = 1500;
+static const int  GAME_HEIGHT = 1125;
+
+static const real WORLD_MAX_WIDTH  = 60000;
+static const real WORLD_MAX_HEIGHT = 60000;
+
+static const real PLAYER_START_X = WORLD_MAX_WIDTH / 2;
+static const real PLAYER_START_Y = WORLD_MAX_HEIGHT / 2;
+
+static const real CAMERA_SPEED = 0.2;
+
+static const real PLAYER_BASE_ROTATE_ACCELERATION  = SIM_PI * 0.003;
+static const real PLAYER_BASE_ROTATE_FRICTION      = SIM_PI * 0.001;
+static const real PLAYER_BASE_ROTATE_TOP_SPEED     = SIM_PI * 0.02;
+static const real PLAYER_BASE_TRASH_GRAB_DISTANCE  = 200;
+static const real PLAYER_BASE_TRASH_THROW_SPEED    = 20; // MUST NOT BE IN THE RANGE OF [TRASH_MIN_VELOCITY, TRASH_MAX_VELOCITY]
+static const real PLAYER_TRASH_DRAW_DISTANCE       = 200;
+static const int  PLAYER_DAMAGED_IFRAMES           = FPS_LIMIT * 3;
+static const real PLAYER_BASE_ACCELERATION         = 0.15;
+static const real PLAYER_FRICTION                  = 0.02;
+static const real PLAYER_BASE_HP                   = 5;
+static const real PLAYER_DYING_ROTATE_SPEED        = SIM_PI * 0.05;
+
+static const real PHYSICS_BASE_TOP_SPEED = 15;
+
+static const real TRASH_MIN_VELOCITY              = 2;
+static const real TRASH_MAX_VELOCITY              = 10;
+static const real TRASH_MIN_ROT_SPEED             = SIM_PI * 0.01;
+static const real TRASH_MAX_ROT_SPEED             = SIM_PI * 0.03;
+static const real TRASH_PLAYER_DIRECTION_ACCURACY = SIM_PI * 0.1;
+static const int  TRASH_LIFETIME                  = FPS_LIMIT * 15;
+static const int  TRASH_FADE_OUT_TIME             = FPS_LIMIT * 3;
+static const real TRASH_SPAWN_DISTANCE            = 1000;
+#define           TRASH_MAX                         ((int)4000)
+#define           TRASH_VARIANTS                    ((int)2)
+static const real TRASH_SPAWN_INTERVAL            = 0.3; // trash spawns every TRASH_SPAWN_INTERVAL seconds
+static const real TRASH_MIN_VALUE                 = 0.15;
+static const real TRASH_MAX_VALUE                 = 2;
+static const real TRASH_AWAKE_RADIUS              = 3000; // Trash this close to the player is always stepped, has to cover everything the game draws
+static const real TRASH_SLEEP_MARGIN              = 500; // Trash has to be this much further out than TRASH_AWAKE_RADIUS to be put to sleep
+
+static const real DRONE_BASE_ACCELERATION        = 0.15;
+static const int  DRONE_DYING_TIMER              = FPS_LIMIT * 3;
+static const real DRONE_DYING_ROTATE_SPEED       = SIM_PI * 0.05;
+static const real DRONE_TRASH_COLLISION_DISTANCE = 100;
+static const real DRONE_SPAWN_DISTANCE           = 2000;
+static const real DRONE_DYING_SPEED              = 3;
+static const real DRONE_DAMAGE_RADIUS            = 150;
+static const real DRONE_SPAWN_INTERVAL           = 10; // trash spawns every TRASH_SPAWN_INTERVAL seconds
+static const real DRONE_MAX_INTERVAL             = 50; // how many seconds between the max number of enemies increases
+static const int  DRONE_SPAWN_DELAY              = FPS_LIMIT * 15; // dont start spawning enemies until this far in
+static const real DRONE_FIGHTER_CHANCE           = 0.3; // chance for a drone to be a fighter drone
+
+static const real GARBAGE_DISPOSAL_START_X        = PLAYER_START_X + 1000;
+static const real GARBAGE_DISPOSAL_START_Y        = PLAYER_START_Y;
+static const real GARBAGE_DISPOSAL_GRAVITY_RADIUS = 800;
+static const real GARBAGE_DISPOSAL_GRAB_RADIUS    = 100;
+static const real GARBAGE_DISPOSAL_GRAVITY        = 0.8;
+
+/********************* Structs **********************/
+
+// Reference to a population slot that stops resolving once the entity in it is gone
+typedef struct {
+	int index;
+	unsigned int generation;
+} EntityHandle;
+
+#define NO_ENTITY ((EntityHandle){-1, 0})
+#define POPULATION_MIN_CAPACITY ((int)64)
+#define SIM_CHUNK_SIZE ((int)256) // Entities per job when a pass is split across threads, results don't depend on thread count
+
+// Physics vector, pixels per tick along each axis
+typedef struct {
+	real x;
+	real y;
+} Vector;
+
+// Physics physics simulation
+typedef struct {
+	real x;
+	real y;
+	Vector velocity;
+	real mass; // Kilograms
+	real lastX; // Position at the start of the last tick
+	real lastY;
+} Physics;
+
+typedef struct {
+	real dirVelocity;
+	real direction;
+	EntityHandle grabbedTrash; // Grabbed trash or NO_ENTITY
+	real hp;
+	int iframes; // iframes left after getting damaged
+} Player;
+
+// The player's ship, there is only ever one so it lives outside of the population
+typedef struct {
+	Physics physics;
+	Player player;
+} PlayerEntity;
+
+// Every live trash, packed so each update pass walks contiguous arrays
+typedef struct {
+	int count;
+	int capacity;
+	int *slot;              // Population slot that owns each trash
+	real *x;
+	real *y;
+	real *lastX;            // Position at the start of the last tick, for drawing in between ticks
+	real *lastY;
+	real *vx;
+	real *vy;
+	int *framesLeftAlive;
+	real *rot;
+	real *rotSpeed;
+	int *variant;           // Which trash texture to draw, [0, TRASH_VARIANTS)
+	bool *grabbed;
+	bool *trashAnimation;
+	bool *wasThrown;
+	bool *lethal;           // Thrown at full speed and hasn't hit anything yet, knocks out drones
+	EntityHandle *disposal; // Garbage disposal it went into, only valid if trashAnimation
+} TrashPool;
+
+// Every live drone
+typedef struct {
+	int count;
+	int capacity;
+	int *slot;
+	real *x;
+	real *y;
+	real *lastX;
+	real *lastY;
+	real *vx;
+	real *vy;
+	bool *dying;
+	int *dyingTimer;
+	real *dyingRotation;
+	bool *fighter;
+} DronePool;
+
+// Every garbage disposal
+typedef struct {
+	int count;
+	int capacity;
+	int *slot;
+	real *x;
+	real *y;
+	real *gravityRadius;    // Thrown trash this close gets pulled in
+	real *gravity;          // How hard it gets pulled
+	real *grabRadius;       // Trash this close goes in
+} DisposalPool;
+
+// Trash far from the player that isn't being stepped, trash nobody has touched only drifts and spins so
+// its state at any later tick follows from the state it was put to sleep with
+typedef struct {
+	long wakeTick;  // Earliest tick it could be within TRASH_AWAKE_RADIUS of the player, or when it expires if that's sooner
+	long sleepTick; // Tick the state below is from
+	real x;
+	real y;
+	real vx;
+	real vy;
+	real rot;
+	real rotSpeed;
+	int framesLeftAlive;
+	int variant;
+} SleepingTrash;
+
+// Min-heap on wakeTick so each tick only looks at the sleeping trash that's due
+typedef struct {
+	SleepingTrash *items;
+	int count;
+	int capacity;
+} SleepingTrashHeap;
+
+// Where a handle's entity currently lives
+typedef struct {
+	entitytype type;         // ENTITY_TYPE_NONE if the slot is free
+	int index;               // Index into the pool for type
+	unsigned int generation; // Bumped whenever the slot is freed
+} PopulationSlot;
+
+// All entities in the game, each type is stored densely in its own pool
+typedef struct {
+	PopulationSlot *slots; // Vector of slots handles refer to
+	int *freeSlots;        // Stack of unused slots
+	int freeCount;         // Number of slots in freeSlots
+	int size;              // Number of slots in the population, used or not
+	TrashPool trash;
+	DronePool drones;
+	DisposalPool disposals;
+	SleepingTrashHeap sleepingTrash; // Trash taken out of the trash pool while it's far from the player
+} Population;
+
+// Controls the player has for a single tick, filled out by whoever is driving the sim
+typedef struct {
+	bool left;         // Rotate counter-clockwise
+	bool right;        // Rotate clockwise
+	bool thrust;       // Accelerate forwards
+	bool grabPressed;  // Grab was pressed this tick
+	bool grabReleased; // Grab was released this tick
+} PlayerInput;
+
+// Something a pass over the population wants done to the rest of the world, passes run in parallel so
+// these are saved up per chunk and applied afterwards in the order a single thread would have
+typedef enum {
+	SIM_COMMAND_REMOVE = 0,    // Remove entity a from the pool being updated
+	SIM_COMMAND_DISPOSE = 1,   // Trash a just went into the garbage disposal
+	SIM_COMMAND_DRONE_HIT = 2, // Drone a ran into lethal trash b
+	SIM_COMMAND_SLEEP = 3,     // Trash a is drifting far from the player, take it out of the pool until it could matter again
+} simcommand;
+
+typedef struct {
+	simcommand type;
+	int a;
+	int b;
+} SimCommand;
+
+typedef struct {
+	SimCommand *commands;
+	int count;
+	int capacity;
+} SimCommandBuffer;
+
+// Region of the world that is on screen, trash and drones spawn just outside of it
+typedef struct {
+	real x;
+	real y;
+	real w;
+	real h;
+} SimView;
+
+/********************* Globals *********************/
+
+/********************* Math functions *********************/
+// Mirrors of the JamUtil maths so the simulation doesn't need it
+real simPointDistance(real x1, real y1, real x2, real y2);
+real simPointAngle(real x1, real y1, real x2, real y2);
+real simCastX(real length, real angle);
+real simCastY(real length, real angle);
+real simClamp(real x, real min, real max);
+real simSign(real x);
+
+/********************* Common functions *********************/
+// Seeds every stream in gWorld->random
+void randomSeed(uint64_t seed);
+real randomReal(randomstream stream);
+int randomRange(randomstream stream, int low, int high);
+real randomRangeReal(randomstream stream, real low, real high);
+
+/********************* Physics functions *********************/
+void physicsStart(Physics *physics, real x, real y);
+
+// Vector of the given length pointing along angle, where 0 is right and positive angles turn clockwise on screen
+Vector vectorFromAngle(real length, real angle);
+
+// Adds an acceleration to a velocity then caps it to PHYSICS_BASE_TOP_SPEED
+void physicsAccelerate(real *vx, real *vy, real ax, real ay);
+
+// Moves every position along its velocity and keeps it in the world, written to vectorize
+void physicsIntegrate(real * restrict x, real * restrict y, const real * restrict vx, const real * restrict vy, int count);
+void physicsUpdate(Physics *physics, Vector *acceleration);
+
+/********************* Entity functions *********************/
+// Start functions fill out a freshly spawned pool entry, update functions return false once the entity is done
+// and only touch their own entity, anything else goes into commands
+void trashStart(int i);
+bool trashUpdate(int i, SimCommandBuffer *commands);
+
+// Moves sleeping trash's state forward to tick in closed form
+void trashAdvanceSleeping(SleepingTrash *sleeping, long tick);
+void droneStart(int i);
+void droneEnd(int i);
+bool droneUpdate(int i);
+void garbageDisposalStart(int i);
+
+/********************* Population functions *********************/
+void simCommandPush(SimCommandBuffer *buffer, simcommand type, int a, int b);
+
+void popInit();
+
+// Adds a zeroed entity to the pool for type and returns its index in that pool
+int popSpawn(entitytype type, EntityHandle *handle);
+
+// Removes an entity from its pool, the last entity in the pool takes its index
+void popRemove(entitytype type, int index);
+void popUpdateEntities();
+void popCollideEntities();
+void popEnd();
+EntityHandle popHandle(entitytype type, int index);
+
+// Returns the pool index a handle refers to or -1 if it's gone or not of the given type
+int popResolve(EntityHandle handle, entitytype type);
+
+/********************* Player functions *********************/
+void playerStart();
+void playerUpdate(const PlayerInput *input);
+void playerEnd();
+void playerTakeDamage(Vector *velocity);
+
+// Deterministic stand-in for a player in headless runs, circles around and grabs/throws trash every second
+PlayerInput simScriptedInput(long tick);
+
+/********************* Simulation functions *********************/
+// Starts a fresh game
+void simStart(uint64_t seed, SimView view);
+
+// Advances the world by one tick (1 / FPS_LIMIT seconds), gWorld->view.w/h should be set to the current view size beforehand
+void simUpdate(const PlayerInput *input);
+
+void simEnd();
+
+// Fingerprint of the world's state, equal hashes after the same tick mean the games haven't diverged
+uint64_t simHash();
+
+/********************* Snapshot functions *********************/
+// Writes the whole world into buffer (grown as needed) and returns how many bytes it took. Arrays are padded to
+// their capacity and split into byte planes, so snapshots of nearby ticks mostly line up byte for byte
+size_t simSnapshotSave(uint8_t **buffer, size_t *capacity);
+
+// Puts the world back to how it was when data was saved, returns false if data isn't a snapshot
+bool simSnapshotLoad(const uint8_t *data, size_t size);
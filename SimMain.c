@@ -0,0 +1,220 @@
+// Headless driver for the simulation, runs the world as fast as it can with a scripted pilot
+//   LECD_sim [ticks] [seed]            scripted pilot, restarts the game whenever the player dies
+//   LECD_sim [ticks] [seed] -r <file>  scripted pilot for a single game, recording it to file
+//   LECD_sim -p <file>                 plays a recording back and checks it against its world hashes
+//   LECD_sim [ticks] [seed] -b <games> plays games seeded seed onwards side by side, each for at most ticks
+//   LECD_sim [seed] -a <worlds>        steps worlds games whenever a controller asks through shared memory (Agent.h),
+//                                      -n <name> names the shared memory
+// -t <threads> can be added to any of them to set how many threads update the world, default is one per core
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "World.h"
+#include "Replay.h"
+#include "Jobs.h"
+#include "Batch.h"
+#include "Agent.h"
+
+const int DEFAULT_TICKS  = 100000;
+const int RESTART_DELAY  = FPS_LIMIT * 3; // ticks to wait after the player dies before starting a new game
+const char USAGE[] =
+	"Usage: LECD_sim [ticks] [seed]            scripted pilot, restarts the game whenever the player dies\n"
+	"       LECD_sim [ticks] [seed] -r <file>  scripted pilot for a single game, recording it to file\n"
+	"       LECD_sim -p <file>                 plays a recording back and checks it against its world hashes\n"
+	"       LECD_sim [ticks] [seed] -b <games> plays games seeded seed onwards side by side, each for at most ticks\n"
+	"       LECD_sim [seed] -a <worlds>        steps worlds games whenever a controller asks through shared memory,\n"
+	"                                          -n <name> names the shared memory\n"
+	"-t <threads> can be added to any of them to set how many threads update the world, default is one per core\n";
+
+// Reads all of text as a whole number no bigger than max, returns false if it's anything else
+bool parseNumber(const char *text, uint64_t max, uint64_t *value) {
+	char *end;
+	errno = 0;
+	*value = strtoull(text, &end, 10);
+	return text[0] >= '0' && text[0] <= '9' && *end == '\0' && errno == 0 && *value <= max;
+}
+
+// Prints what was wrong with the arguments and how to use them, returns the process exit code
+int usage(const char *problem, const char *argument) {
+	fprintf(stderr, "%s \"%s\"\n%s", problem, argument, USAGE);
+	return 1;
+}
+
+// Seconds since some arbitrary point
+double wallTime() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
+
+SimView defaultView() {
+	SimView view = {PLAYER_START_X - (GAME_WIDTH / 2), PLAYER_START_Y - (GAME_HEIGHT / 2), GAME_WIDTH, GAME_HEIGHT};
+	return view;
+}
+
+// Runs a recording back as fast as possible, returns the process exit code
+int playReplay(const char *filename) {
+	Replay replay = {};
+	if (!replayLoad(&replay, filename)) {
+		fprintf(stderr, "Failed to load replay \"%s\"\n", filename);
+		return 1;
+	}
+
+	long divergedTick = -1;
+	PlayerInput input;
+	simStart(replay.seed, replay.view);
+	gWorld->lod = replay.lod;
+	double start = wallTime();
+	while (replayNext(&replay, &input)) {
+		simUpdate(&input);
+		if (!replayVerify(&replay) && divergedTick == -1)
+			divergedTick = replay.tick;
+	}
+	double elapsed = wallTime() - start;
+
+	printf("{\"ticks\": %ld, \"seconds\": %f, \"ticks_per_second\": %f, \"score\": %f, \"diverged_tick\": %ld}\n",
+		   replay.tick, elapsed, elapsed > 0 ? (double)replay.tick / elapsed : 0, gWorld->score, divergedTick);
+	simEnd();
+	replayFree(&replay);
+	return divergedTick == -1 ? 0 : 1;
+}
+
+// Plays a batch of games across every core and prints how they went
+int runBatch(int games, long ticks, uint64_t seed) {
+	BatchConfig config = {games, ticks, seed, defaultView()};
+	BatchSummary summary;
+	batchRun(&config, NULL, &summary);
+	printf("{\"games\": %i, \"max_ticks\": %ld, \"world_ticks\": %ld, \"seconds\": %f, \"world_ticks_per_second\": %f, "
+		   "\"survived\": %i, \"mean_score\": %f, \"median_score\": %f, \"p90_score\": %f, \"max_score\": %f, "
+		   "\"mean_seconds\": %f, \"mean_kills\": %f, \"mean_trash_disposed\": %f, \"threads\": %i}\n",
+		   summary.games, ticks, summary.worldTicks, summary.seconds, summary.seconds > 0 ? summary.worldTicks / summary.seconds : 0,
+		   summary.survived, summary.meanScore, summary.medianScore, summary.p90Score, summary.maxScore,
+		   summary.meanTicks / FPS_LIMIT, summary.meanKills, summary.meanTrashDisposed, jobsWorkerCount());
+	return 0;
+}
+
+int main(int argc, const char **argv) {
+	long ticks = DEFAULT_TICKS;
+	uint64_t seed = 0;
+	const char *recordFile = NULL;
+	const char *playFile = NULL;
+	int threads = 0;
+	int batchGames = 0;
+	int agentWorlds = 0;
+	const char *agentName = AGENT_SHARED_NAME;
+	uint64_t positionals[2];
+	int positional = 0;
+	int firstPositional = 0;
+	for (int i = 1; i < argc; i++) {
+		const char *flag = argv[i];
+		if (flag[0] != '-') {
+			if (positional == 2)
+				return usage("Too many arguments at", flag);
+			if (positional == 0)
+				firstPositional = i;
+			if (!parseNumber(flag, UINT64_MAX, &positionals[positional++]))
+				return usage("Expected a number but got", flag);
+			continue;
+		}
+
+		// Every flag takes a value
+		if (strlen(flag) != 2 || strchr("prntba", flag[1]) == NULL)
+			return usage("Unknown option", flag);
+		if (i + 1 == argc)
+			return usage("Missing a value after", flag);
+		const char *value = argv[++i];
+		uint64_t number;
+		// Counts of threads, games and worlds all have to be at least 1, leaving -t out is how to get one thread per core
+		bool numeric = parseNumber(value, INT_MAX, &number) && number > 0;
+		if (strcmp(flag, "-p") == 0)
+			playFile = value;
+		else if (strcmp(flag, "-r") == 0)
+			recordFile = value;
+		else if (strcmp(flag, "-n") == 0)
+			agentName = value;
+		else if (strcmp(flag, "-t") == 0 && numeric)
+			threads = number;
+		else if (strcmp(flag, "-b") == 0 && numeric)
+			batchGames = number;
+		else if (strcmp(flag, "-a") == 0 && numeric)
+			agentWorlds = number;
+		else
+			return usage("Expected a number above 0 but got", value);
+	}
+
+	// The controller decides how long an agent runs so its only number is the seed
+	if (agentWorlds > 0 && positional == 2)
+		return usage("Agents only take a seed, not ticks and a seed, starting at", argv[firstPositional]);
+	else if (agentWorlds > 0 && positional == 1)
+		seed = positionals[0];
+	else if (positional >= 1 && positionals[0] > LONG_MAX)
+		return usage("Too many ticks", argv[firstPositional]);
+	else if (positional >= 1)
+		ticks = positionals[0];
+	if (positional == 2)
+		seed = positionals[1];
+	jobsInit(threads);
+	if (playFile != NULL) {
+		int result = playReplay(playFile);
+		jobsFree();
+		return result;
+	} else if (batchGames > 0) {
+		int result = runBatch(batchGames, ticks, seed);
+		jobsFree();
+		return result;
+	} else if (agentWorlds > 0) {
+		bool served = agentServe(agentName, agentWorlds, seed);
+		jobsFree();
+		if (!served)
+			fprintf(stderr, "Failed to create shared memory \"%s\"\n", agentName);
+		return served ? 0 : 1;
+	}
+
+	int games = 1;
+	int deadTicks = 0;
+	int peakPopulation = 0;
+	real bestScore = 0;
+	Replay replay = {};
+
+	simStart(seed, defaultView());
+	if (recordFile != NULL)
+		replayStartRecording(&replay, seed, defaultView());
+	double start = wallTime();
+	for (long tick = 0; tick < ticks; tick++) {
+		PlayerInput input = simScriptedInput(tick);
+		simUpdate(&input);
+		if (recordFile != NULL)
+			replayRecord(&replay, &input);
+		int population = gWorld->population.trash.count + gWorld->population.sleepingTrash.count + gWorld->population.drones.count;
+		peakPopulation = population > peakPopulation ? population : peakPopulation;
+
+		// Start a new game some time after the player dies so long soaks keep exercising everything, recordings are one game
+		if (recordFile == NULL && gWorld->player.player.hp <= 0 && ++deadTicks >= RESTART_DELAY) {
+			bestScore = gWorld->score > bestScore ? gWorld->score : bestScore;
+			simEnd();
+			simStart(seed + games, defaultView());
+			games++;
+			deadTicks = 0;
+		}
+	}
+	double elapsed = wallTime() - start;
+	bestScore = gWorld->score > bestScore ? gWorld->score : bestScore;
+	simEnd();
+
+	if (recordFile != NULL) {
+		bool saved = replaySave(&replay, recordFile);
+		replayFree(&replay);
+		if (!saved) {
+			fprintf(stderr, "Failed to save replay \"%s\"\n", recordFile);
+			return 1;
+		}
+	}
+
+	printf("{\"ticks\": %ld, \"seconds\": %f, \"ticks_per_second\": %f, \"games\": %i, \"peak_population\": %i, \"best_score\": %f, \"threads\": %i}\n",
+		   ticks, elapsed, elapsed > 0 ? (double)ticks / elapsed : 0, games, peakPopulation, bestScore, jobsWorkerCount());
+	jobsFree();
+	return 0;
+}
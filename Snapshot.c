@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Snapshot.h"
+#include "World.h"
+
+/********************* Internal functions *********************/
+// Byte i of the snapshot a delta is against, past the end of it everything is against zero
+#define SNAPSHOT_BASE(prev, prevSize, i) ((i) < (prevSize) ? (prev)[i] : 0)
+
+static void snapshotReserve(uint8_t **buffer, size_t *capacity, size_t size) {
+	if (size > *capacity) {
+		*capacity = size;
+		*buffer = realloc(*buffer, size);
+	}
+}
+
+static SnapshotFrame *snapshotFrame(SnapshotRing *ring, int n) {
+	return &ring->frames[(ring->start + n) % ring->capacity];
+}
+
+static uint8_t *snapshotWriteVarint(uint8_t *out, size_t value) {
+	for (; value >= 0x80; value >>= 7)
+		*out++ = (uint8_t)(value | 0x80);
+	*out++ = (uint8_t)value;
+	return out;
+}
+
+static bool snapshotReadVarint(const uint8_t **in, const uint8_t *end, size_t *value) {
+	*value = 0;
+	for (int shift = 0; *in < end && shift < 64; shift += 7) {
+		uint8_t byte = *(*in)++;
+		*value |= (size_t)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+// Word of the delta starting at byte i, which has at least a word after it
+static uint64_t snapshotDelta(const uint8_t *cur, const uint8_t *prev, size_t prevSize, size_t i) {
+	uint64_t a, b = 0;
+	memcpy(&a, cur + i, sizeof(uint64_t));
+	if (i + sizeof(uint64_t) <= prevSize)
+		memcpy(&b, prev + i, sizeof(uint64_t));
+	else if (i < prevSize)
+		memcpy(&b, prev + i, prevSize - i);
+	return a ^ b;
+}
+
+// Runs are found a word at a time, the few bytes past the last whole word always go in with the last changed run
+static void snapshotEncode(SnapshotFrame *frame, const uint8_t *cur, size_t size, const uint8_t *prev, size_t prevSize) {
+	snapshotReserve(&frame->data, &frame->capacity, size + (size / sizeof(uint64_t)) + 32);
+	uint8_t *out = frame->data;
+	size_t i = 0;
+	while (i < size) {
+		size_t literal = i;
+		while (literal + sizeof(uint64_t) <= size && snapshotDelta(cur, prev, prevSize, literal) == 0)
+			literal += sizeof(uint64_t);
+		size_t end = literal;
+		while (end + sizeof(uint64_t) <= size && snapshotDelta(cur, prev, prevSize, end) != 0)
+			end += sizeof(uint64_t);
+		if (end + sizeof(uint64_t) > size)
+			end = size;
+		out = snapshotWriteVarint(out, literal - i);
+		out = snapshotWriteVarint(out, end - literal);
+		size_t j = literal;
+		for (; j + sizeof(uint64_t) <= end; j += sizeof(uint64_t)) {
+			uint64_t delta = snapshotDelta(cur, prev, prevSize, j);
+			memcpy(out, &delta, sizeof(uint64_t));
+			out += sizeof(uint64_t);
+		}
+		for (; j < end; j++)
+			*out++ = cur[j] ^ SNAPSHOT_BASE(prev, prevSize, j);
+		i = end;
+	}
+	frame->size = out - frame->data;
+	frame->rawSize = size;
+}
+
+static bool snapshotDecode(const SnapshotFrame *frame, uint8_t *out, const uint8_t *prev, size_t prevSize) {
+	const uint8_t *in = frame->data;
+	const uint8_t *end = frame->data + frame->size;
+	size_t i = 0;
+	while (i < frame->rawSize) {
+		size_t zeros, literal;
+		if (!snapshotReadVarint(&in, end, &zeros) || !snapshotReadVarint(&in, end, &literal))
+			return false;
+		if (zeros > frame->rawSize - i || literal > frame->rawSize - i - zeros || literal > (size_t)(end - in))
+			return false;
+		size_t copied = i < prevSize ? (prevSize - i < zeros ? prevSize - i : zeros) : 0;
+		if (copied > 0)
+			memcpy(out + i, prev + i, copied);
+		memset(out + i + copied, 0, zeros - copied);
+		i += zeros;
+		for (size_t j = 0; j < literal; j++, i++)
+			out[i] = in[j] ^ SNAPSHOT_BASE(prev, prevSize, i);
+		in += literal;
+	}
+	return true;
+}
+
+static void snapshotSwap(SnapshotRing *ring) {
+	uint8_t *buffer = ring->last;
+	size_t capacity = ring->lastCapacity;
+	ring->last = ring->scratch;
+	ring->lastCapacity = ring->scratchCapacity;
+	ring->scratch = buffer;
+	ring->scratchCapacity = capacity;
+}
+
+/********************* Snapshot functions *********************/
+void snapshotInit(SnapshotRing *ring, int ticks) {
+	memset(ring, 0, sizeof(SnapshotRing));
+	ring->capacity = ticks > 0 ? ticks : 1;
+	ring->frames = calloc(ring->capacity, sizeof(SnapshotFrame));
+}
+
+void snapshotFree(SnapshotRing *ring) {
+	for (int i = 0; i < ring->capacity; i++)
+		free(ring->frames[i].data);
+	free(ring->frames);
+	free(ring->last);
+	free(ring->scratch);
+	memset(ring, 0, sizeof(SnapshotRing));
+}
+
+void snapshotClear(SnapshotRing *ring) {
+	ring->start = 0;
+	ring->count = 0;
+	ring->lastSize = 0;
+}
+
+void snapshotCapture(SnapshotRing *ring) {
+	size_t size = simSnapshotSave(&ring->scratch, &ring->scratchCapacity);
+
+	// The oldest frame makes way once the history is full, its buffer gets reused
+	if (ring->count == ring->capacity) {
+		ring->start = (ring->start + 1) % ring->capacity;
+		ring->count--;
+	}
+	SnapshotFrame *frame = snapshotFrame(ring, ring->count++);
+	frame->tick = gWorld->ticks;
+	frame->keyframe = ring->count == 1 || gWorld->ticks % SNAPSHOT_KEYFRAME_INTERVAL == 0;
+	if (frame->keyframe)
+		snapshotEncode(frame, ring->scratch, size, NULL, 0);
+	else
+		snapshotEncode(frame, ring->scratch, size, ring->last, ring->lastSize);
+	snapshotSwap(ring);
+	ring->lastSize = size;
+}
+
+// Frames before the first keyframe lost the one they were diffed from when it made way
+long snapshotOldest(SnapshotRing *ring) {
+	for (int n = 0; n < ring->count; n++)
+		if (snapshotFrame(ring, n)->keyframe)
+			return snapshotFrame(ring, n)->tick;
+	return -1;
+}
+
+long snapshotNewest(SnapshotRing *ring) {
+	return snapshotOldest(ring) >= 0 ? snapshotFrame(ring, ring->count - 1)->tick : -1;
+}
+
+bool snapshotRestore(SnapshotRing *ring, long tick) {
+	int target = ring->count - 1;
+	while (target >= 0 && snapshotFrame(ring, target)->tick != tick)
+		target--;
+	int key = target;
+	while (key >= 0 && !snapshotFrame(ring, key)->keyframe)
+		key--;
+	if (key < 0)
+		return false;
+
+	// Decode forwards from the keyframe, whatever was in last goes since everything after tick is forgotten
+	for (int n = key; n <= target; n++) {
+		SnapshotFrame *frame = snapshotFrame(ring, n);
+		snapshotReserve(&ring->scratch, &ring->scratchCapacity, frame->rawSize);
+		bool decoded = n == key ? snapshotDecode(frame, ring->scratch, NULL, 0) : snapshotDecode(frame, ring->scratch, ring->last, ring->lastSize);
+		snapshotSwap(ring);
+		ring->lastSize = frame->rawSize;
+		if (!decoded) {
+			snapshotClear(ring);
+			return false;
+		}
+	}
+	ring->count = target + 1;
+	return simSnapshotLoad(ring->last, ring->lastSize);
+}
+
+size_t snapshotMemory(SnapshotRing *ring) {
+	size_t size = 0;
+	for (int n = 0; n < ring->count; n++)
+		size += snapshotFrame(ring, n)->size;
+	return size;
+}
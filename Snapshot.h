@@ -0,0 +1,54 @@
+// History of the last few seconds of the world, one snapshot per tick, so the game can be put back to any of them
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Sim.h"
+
+/********************* Constants **********************/
+#define SNAPSHOT_KEYFRAME_INTERVAL ((long)60) // Ticks that are a multiple of this are stored whole, the rest as deltas
+
+/********************* Structs **********************/
+// One tick's snapshot XORed against the tick before it (or against nothing for keyframes), then run length encoded
+// a word at a time as pairs of unchanged and changed byte counts as varints, each followed by the changed bytes
+typedef struct {
+	long tick;
+	bool keyframe;
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+	size_t rawSize;  // Size of the snapshot once decoded
+} SnapshotFrame;
+
+typedef struct {
+	SnapshotFrame *frames;
+	int capacity;          // Ticks of history kept
+	int start;             // Oldest frame
+	int count;
+	uint8_t *last;         // Latest snapshot decoded, what the next one is diffed against
+	size_t lastSize;
+	size_t lastCapacity;
+	uint8_t *scratch;
+	size_t scratchCapacity;
+} SnapshotRing;
+
+/********************* Functions *********************/
+// Keeps up to ticks snapshots
+void snapshotInit(SnapshotRing *ring, int ticks);
+void snapshotFree(SnapshotRing *ring);
+
+// Forgets every snapshot, call alongside simStart
+void snapshotClear(SnapshotRing *ring);
+
+// Saves the world as it is now, call right after simStart and every simUpdate
+void snapshotCapture(SnapshotRing *ring);
+
+// Oldest and newest tick that can be restored, oldest is -1 if there are none
+long snapshotOldest(SnapshotRing *ring);
+long snapshotNewest(SnapshotRing *ring);
+
+// Puts the world back to how it was after tick and forgets everything after it so capturing carries on from
+// there, returns false if tick isn't in the history
+bool snapshotRestore(SnapshotRing *ring, long tick);
+
+// Bytes of encoded snapshots being kept
+size_t snapshotMemory(SnapshotRing *ring);
@@ -0,0 +1,245 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Spatial.h"
+
+/********************* Internal functions *********************/
+static int spatialCell(real coordinate) {
+	return (int)floor(coordinate / SPATIAL_CELL_SIZE);
+}
+
+static int spatialBucket(SpatialHash *hash, int cellX, int cellY) {
+	return (int)(((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellY * 19349663u)) & (hash->bucketCount - 1);
+}
+
+/********************* Spatial hash functions *********************/
+void spatialInit(SpatialHash *hash) {
+	memset(hash, 0, sizeof(SpatialHash));
+}
+
+void spatialFree(SpatialHash *hash) {
+	free(hash->bucketStart);
+	free(hash->items);
+	free(hash->pending);
+	memset(hash, 0, sizeof(SpatialHash));
+}
+
+void spatialClear(SpatialHash *hash) {
+	hash->count = 0;
+}
+
+void spatialInsert(SpatialHash *hash, int index, entitytype type, real x, real y) {
+	if (hash->count == hash->capacity) {
+		hash->capacity = hash->capacity == 0 ? 256 : hash->capacity * 2;
+		hash->items = realloc(hash->items, hash->capacity * sizeof(SpatialItem));
+		hash->pending = realloc(hash->pending, hash->capacity * sizeof(SpatialItem));
+	}
+	SpatialItem *item = &hash->pending[hash->count++];
+	item->index = index;
+	item->type = type;
+	item->cellX = spatialCell(x);
+	item->cellY = spatialCell(y);
+	item->x = x;
+	item->y = y;
+}
+
+void spatialBuild(SpatialHash *hash) {
+	// Keep the load factor at or under a half so clearing the buckets costs about as much as the items
+	int buckets = SPATIAL_MIN_BUCKETS;
+	while (buckets < hash->count * 2)
+		buckets *= 2;
+	if (buckets != hash->bucketCount) {
+		hash->bucketCount = buckets;
+		hash->bucketStart = realloc(hash->bucketStart, (buckets + 1) * sizeof(int));
+	}
+
+	// Counting sort of the pending items into their buckets
+	memset(hash->bucketStart, 0, (hash->bucketCount + 1) * sizeof(int));
+	for (int i = 0; i < hash->count; i++)
+		hash->bucketStart[spatialBucket(hash, hash->pending[i].cellX, hash->pending[i].cellY) + 1]++;
+	for (int i = 0; i < hash->bucketCount; i++)
+		hash->bucketStart[i + 1] += hash->bucketStart[i];
+
+	// bucketStart[b] is used as the insertion cursor then shifted back after
+	for (int i = 0; i < hash->count; i++) {
+		int bucket = spatialBucket(hash, hash->pending[i].cellX, hash->pending[i].cellY);
+		hash->items[hash->bucketStart[bucket]++] = hash->pending[i];
+	}
+	for (int i = hash->bucketCount; i > 0; i--)
+		hash->bucketStart[i] = hash->bucketStart[i - 1];
+	hash->bucketStart[0] = 0;
+}
+
+void spatialBuildFromPopulation(SpatialHash *hash, Population *population) {
+	spatialClear(hash);
+	for (int i = 0; i < population->disposals.count; i++)
+		spatialInsert(hash, i, ENTITY_TYPE_GARBAGE_DISPOSAL, population->disposals.x[i], population->disposals.y[i]);
+	for (int i = 0; i < population->trash.count; i++)
+		spatialInsert(hash, i, ENTITY_TYPE_TRASH, population->trash.x[i], population->trash.y[i]);
+	for (int i = 0; i < population->drones.count; i++)
+		spatialInsert(hash, i, ENTITY_TYPE_DRONE, population->drones.x[i], population->drones.y[i]);
+	spatialBuild(hash);
+}
+
+// Walks every item matching typeMask within radius of (x, y), stops early if visit returns false
+typedef bool (*SpatialVisitor)(SpatialItem *item, real distance, void *data);
+static int spatialQueryItems(SpatialHash *hash, real x, real y, real radius, unsigned int typeMask, SpatialVisitor visit, void *data) {
+	int found = 0;
+	int minX = spatialCell(x - radius);
+	int maxX = spatialCell(x + radius);
+	int minY = spatialCell(y - radius);
+	int maxY = spatialCell(y + radius);
+	real radiusSquared = radius * radius;
+
+	for (int cellY = minY; cellY <= maxY; cellY++) {
+		for (int cellX = minX; cellX <= maxX; cellX++) {
+			int bucket = spatialBucket(hash, cellX, cellY);
+			for (int i = hash->bucketStart[bucket]; i < hash->bucketStart[bucket + 1]; i++) {
+				SpatialItem *item = &hash->items[i];
+
+				// Buckets are shared between cells so anything not in this exact cell is skipped
+				if (item->cellX != cellX || item->cellY != cellY || !(typeMask & SPATIAL_MASK(item->type)))
+					continue;
+				real dx = item->x - x;
+				real dy = item->y - y;
+				real distanceSquared = (dx * dx) + (dy * dy);
+				if (distanceSquared < radiusSquared) {
+					found++;
+					if (visit != NULL && !visit(item, sqrt(distanceSquared), data))
+						return found;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+typedef struct {
+	SpatialCallback callback;
+	void *data;
+} SpatialRadiusQuery;
+
+static bool spatialRadiusVisit(SpatialItem *item, real distance, void *data) {
+	SpatialRadiusQuery *query = data;
+	return query->callback(item->index, distance, query->data);
+}
+
+int spatialQueryRadius(SpatialHash *hash, real x, real y, real radius, unsigned int typeMask, SpatialCallback callback, void *data) {
+	if (hash->bucketCount == 0)
+		return 0;
+	SpatialRadiusQuery query = {callback, data};
+	return spatialQueryItems(hash, x, y, radius, typeMask, callback != NULL ? spatialRadiusVisit : NULL, &query);
+}
+
+// Adds item to the k nearest so far (best is squared distances, ascending) if it belongs there
+static void spatialNearestConsider(SpatialItem *item, real x, real y, real radiusSquared, unsigned int typeMask, SpatialFilter filter,
+								   void *data, int k, int *found, real *best, int *bestIndex) {
+	if (!(typeMask & SPATIAL_MASK(item->type)))
+		return;
+	real dx = item->x - x;
+	real dy = item->y - y;
+	real distanceSquared = (dx * dx) + (dy * dy);
+	if (distanceSquared >= radiusSquared || (*found == k && distanceSquared >= best[k - 1]))
+		return;
+	if (filter != NULL && !filter(item->index, item->type, data))
+		return;
+
+	// Insert it in order, pushing the furthest out if already full
+	int j = *found < k ? (*found)++ : k - 1;
+	for (; j > 0 && best[j - 1] > distanceSquared; j--) {
+		best[j] = best[j - 1];
+		bestIndex[j] = bestIndex[j - 1];
+	}
+	best[j] = distanceSquared;
+	bestIndex[j] = item->index;
+}
+
+int spatialQueryNearest(SpatialHash *hash, real x, real y, real radius, unsigned int typeMask, SpatialFilter filter, void *data, int k, int *indices, real *distances) {
+	if (hash->bucketCount == 0 || k <= 0)
+		return 0;
+	int found = 0;
+	int centerX = spatialCell(x);
+	int centerY = spatialCell(y);
+	int maxRing = (int)ceil(radius / SPATIAL_CELL_SIZE);
+	real radiusSquared = radius * radius;
+	real best[k]; // Squared distances of what's been found so far, ascending
+	int bestIndex[k];
+
+	for (int ring = 0; ring <= maxRing; ring++) {
+		// Everything in this ring or further out is at least (ring - 1) cells away
+		real ringDistance = (ring - 1) * SPATIAL_CELL_SIZE;
+		if (ring > 0 && found == k && ringDistance * ringDistance >= best[k - 1])
+			break;
+
+		// Far out the rings are mostly empty cells, past the point where a ring has more cells than
+		// there are items it's cheaper to just check every item that wasn't in an earlier ring
+		if (ring * 8 > hash->count) {
+			for (int i = 0; i < hash->count; i++) {
+				SpatialItem *item = &hash->items[i];
+				int cellDistance = abs(item->cellX - centerX) > abs(item->cellY - centerY) ? abs(item->cellX - centerX) : abs(item->cellY - centerY);
+				if (cellDistance >= ring)
+					spatialNearestConsider(item, x, y, radiusSquared, typeMask, filter, data, k, &found, best, bestIndex);
+			}
+			break;
+		}
+
+		for (int cellY = centerY - ring; cellY <= centerY + ring; cellY++) {
+			// Only the outline of the ring, the inside was covered by earlier rings
+			int step = cellY == centerY - ring || cellY == centerY + ring ? 1 : ring * 2;
+			for (int cellX = centerX - ring; cellX <= centerX + ring; cellX += step) {
+				int bucket = spatialBucket(hash, cellX, cellY);
+				for (int i = hash->bucketStart[bucket]; i < hash->bucketStart[bucket + 1]; i++)
+					if (hash->items[i].cellX == cellX && hash->items[i].cellY == cellY)
+						spatialNearestConsider(&hash->items[i], x, y, radiusSquared, typeMask, filter, data, k, &found, best, bestIndex);
+			}
+		}
+	}
+
+	for (int i = 0; i < found; i++) {
+		if (indices != NULL)
+			indices[i] = bestIndex[i];
+		if (distances != NULL)
+			distances[i] = sqrt(best[i]);
+	}
+	return found;
+}
+
+typedef struct {
+	int indexA;
+	entitytype typeA;
+	bool symmetric; // The first half of the pair could also be found as a partner
+	unsigned int maskA;
+	SpatialPairCallback callback;
+	void *data;
+	bool stop;
+} SpatialPairQuery;
+
+static bool spatialPairVisit(SpatialItem *item, real distance, void *data) {
+	SpatialPairQuery *query = data;
+
+	// Indices are per pool so an item is only itself if the type matches too. Pairs where both sides match maskA are
+	// visited from either end so only the one that's lower by type then index reports it
+	bool self = item->index == query->indexA && item->type == query->typeA;
+	bool lower = item->type < query->typeA || (item->type == query->typeA && item->index < query->indexA);
+	if (self || (query->symmetric && (query->maskA & SPATIAL_MASK(item->type)) && lower))
+		return true;
+	query->stop = !query->callback(query->indexA, item->index, distance, query->data);
+	return !query->stop;
+}
+
+void spatialForEachPair(SpatialHash *hash, real radius, unsigned int maskA, unsigned int maskB, SpatialPairCallback callback, void *data) {
+	spatialForEachPairRange(hash, radius, maskA, maskB, 0, hash->count, callback, data);
+}
+
+void spatialForEachPairRange(SpatialHash *hash, real radius, unsigned int maskA, unsigned int maskB, int begin, int end, SpatialPairCallback callback, void *data) {
+	SpatialPairQuery query = {0, ENTITY_TYPE_NONE, false, maskA, callback, data, false};
+	for (int i = begin; i < end && !query.stop; i++) {
+		SpatialItem *item = &hash->items[i];
+		if (!(maskA & SPATIAL_MASK(item->type)))
+			continue;
+		query.indexA = item->index;
+		query.typeA = item->type;
+		query.symmetric = (maskB & SPATIAL_MASK(item->type)) != 0;
+		spatialQueryItems(hash, item->x, item->y, radius, maskB, spatialPairVisit, &query);
+	}
+}
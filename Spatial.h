@@ -0,0 +1,61 @@
+// Uniform grid over the world with its cells hashed into buckets, used for all proximity queries
+#pragma once
+#include "Sim.h"
+
+/********************* Constants **********************/
+#define SPATIAL_CELL_SIZE ((real)256)
+#define SPATIAL_MIN_BUCKETS ((int)64) // Bucket count is the next power of two at least twice the item count
+#define SPATIAL_MASK(type) (1u << (type))
+#define SPATIAL_MASK_ALL  (~0u)
+
+/********************* Structs **********************/
+typedef struct {
+	int index;       // Index into the population's pool for type
+	entitytype type;
+	int cellX;
+	int cellY;
+	real x;
+	real y;
+} SpatialItem;
+
+typedef struct {
+	int *bucketStart;                     // Items in bucket b are items[bucketStart[b]] to items[bucketStart[b + 1] - 1]
+	int bucketCount;                      // Always a power of two
+	SpatialItem *items;                   // Sorted by bucket after spatialBuild
+	SpatialItem *pending;                 // Inserted since the last spatialClear, unsorted
+	int count;
+	int capacity;
+} SpatialHash;
+
+// Return false to stop the query early
+typedef bool (*SpatialCallback)(int index, real distance, void *data);
+typedef bool (*SpatialPairCallback)(int indexA, int indexB, real distance, void *data);
+
+// Return false to leave an item out of a nearest query
+typedef bool (*SpatialFilter)(int index, entitytype type, void *data);
+
+/********************* Functions *********************/
+void spatialInit(SpatialHash *hash);
+void spatialFree(SpatialHash *hash);
+
+// Removes everything, spatialInsert then spatialBuild to fill it back up
+void spatialClear(SpatialHash *hash);
+void spatialInsert(SpatialHash *hash, int index, entitytype type, real x, real y);
+void spatialBuild(SpatialHash *hash);
+
+// Clears the hash and fills it with every live entity in the population
+void spatialBuildFromPopulation(SpatialHash *hash, Population *population);
+
+// Calls callback for every item matching typeMask within radius of (x, y), returns how many were found
+int spatialQueryRadius(SpatialHash *hash, real x, real y, real radius, unsigned int typeMask, SpatialCallback callback, void *data);
+
+// Finds up to k items matching typeMask and filter (which may be NULL) within radius of (x, y), nearest first. Their indices
+// and distances are written to indices and distances (which may be NULL), returns how many were found. Cells are searched
+// in rings moving outwards so the cost depends on how far away the results are rather than on radius.
+int spatialQueryNearest(SpatialHash *hash, real x, real y, real radius, unsigned int typeMask, SpatialFilter filter, void *data, int k, int *indices, real *distances);
+
+// Calls callback for every item in maskA paired with every item in maskB within radius of it, each pair is only visited once
+void spatialForEachPair(SpatialHash *hash, real radius, unsigned int maskA, unsigned int maskB, SpatialPairCallback callback, void *data);
+
+// spatialForEachPair but only for the maskA items in items[begin, end), ranges can be run on different threads at once
+void spatialForEachPairRange(SpatialHash *hash, real radius, unsigned int maskA, unsigned int maskB, int begin, int end, SpatialPairCallback callback, void *data);
@@ -0,0 +1,228 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Stats.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/********************* Constants **********************/
+static const char STATS_MAGIC[8] = {'L', 'E', 'C', 'D', 'R', 'U', 'N', '1'};
+#define STATS_FILENAME_LENGTH ((int)256)
+
+/********************* Structs **********************/
+typedef struct {
+	pthread_t thread;
+	pthread_mutex_t lock;    // Only held to sleep and wake the writer, never during disk access
+	pthread_cond_t wake;     // Signalled when a run is queued or it's time to quit
+	bool quit;
+	bool running;
+	char highscoreFile[STATS_FILENAME_LENGTH];
+	char logFile[STATS_FILENAME_LENGTH];
+
+	// Single producer single consumer ring, statsSubmit only moves head and the writer only moves tail
+	StatsRun queue[STATS_QUEUE_SIZE];
+	atomic_uint head;
+	atomic_uint tail;
+
+	_Atomic double highscore;
+} StatsWriter;
+
+/********************* Globals *********************/
+static StatsWriter gStats = {};
+
+/********************* Internal functions *********************/
+static bool statsPop(StatsRun *run) {
+	unsigned int tail = atomic_load_explicit(&gStats.tail, memory_order_relaxed);
+	if (tail == atomic_load_explicit(&gStats.head, memory_order_acquire))
+		return false;
+	*run = gStats.queue[tail & (STATS_QUEUE_SIZE - 1)];
+	atomic_store_explicit(&gStats.tail, tail + 1, memory_order_release);
+	return true;
+}
+
+static bool statsEmpty() {
+	return atomic_load_explicit(&gStats.tail, memory_order_relaxed) == atomic_load_explicit(&gStats.head, memory_order_acquire);
+}
+
+// Makes sure everything written to f is on the disk before it's closed
+static bool statsClose(FILE *f) {
+	bool ok = fflush(f) == 0;
+#ifdef _WIN32
+	ok = ok && _commit(_fileno(f)) == 0;
+#else
+	ok = ok && fsync(fileno(f)) == 0;
+#endif
+	return fclose(f) == 0 && ok;
+}
+
+// Writes the file next to filename then swaps it in, so a crash leaves either the old file or the new one
+static bool statsReplace(const char *filename, const void *header, size_t headerSize, const void *data, size_t size) {
+	char temp[STATS_FILENAME_LENGTH + 4];
+	snprintf(temp, sizeof(temp), "%s.tmp", filename);
+	FILE *f = fopen(temp, "wb");
+	if (f == NULL)
+		return false;
+	bool ok = fwrite(header, 1, headerSize, f) == headerSize && (size == 0 || fwrite(data, 1, size, f) == size);
+	ok = statsClose(f) && ok;
+#ifdef _WIN32
+	ok = ok && MoveFileExA(temp, filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	ok = ok && rename(temp, filename) == 0;
+#endif
+	if (!ok)
+		remove(temp);
+	return ok;
+}
+
+// Scans the log for its best score, a run cut off by a crash mid write gets dropped so the log is whole records again
+static double statsLoadLog() {
+	FILE *f = fopen(gStats.logFile, "rb");
+	if (f == NULL)
+		return 0;
+	char magic[sizeof(STATS_MAGIC)];
+	long size = 0;
+	bool valid = fread(magic, 1, sizeof(magic), f) == sizeof(magic) && memcmp(magic, STATS_MAGIC, sizeof(magic)) == 0 &&
+				 fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= (long)sizeof(STATS_MAGIC);
+	size_t count = valid ? (size - sizeof(STATS_MAGIC)) / sizeof(StatsRun) : 0;
+	StatsRun *runs = count > 0 ? malloc(count * sizeof(StatsRun)) : NULL;
+	if (runs != NULL) {
+		fseek(f, sizeof(STATS_MAGIC), SEEK_SET);
+		count = fread(runs, sizeof(StatsRun), count, f);
+	}
+	fclose(f);
+
+	double best = 0;
+	for (size_t i = 0; i < count; i++)
+		if (runs[i].score > best)
+			best = runs[i].score;
+	if (!valid || (size_t)size != sizeof(STATS_MAGIC) + (count * sizeof(StatsRun))) {
+		if (!statsReplace(gStats.logFile, STATS_MAGIC, sizeof(STATS_MAGIC), runs, count * sizeof(StatsRun)))
+			printf("Failed to repair run log \"%s\"\n", gStats.logFile);
+	}
+	free(runs);
+	return best;
+}
+
+static void statsLoad() {
+	double highscore = 0;
+	FILE *f = fopen(gStats.highscoreFile, "rb");
+	if (f != NULL) {
+		if (fread(&highscore, sizeof(double), 1, f) != 1)
+			highscore = 0;
+		fclose(f);
+	}
+
+	// The log has every run in it too in case the highscore file went missing
+	double logged = statsLoadLog();
+	if (logged > highscore)
+		highscore = logged;
+	if (highscore > atomic_load(&gStats.highscore))
+		atomic_store(&gStats.highscore, highscore);
+}
+
+// Appends a batch of runs to the log and saves the highscore if one of them beat it
+static void statsWrite(const StatsRun *runs, int count) {
+	FILE *f = fopen(gStats.logFile, "ab");
+	bool ok = f != NULL;
+	if (ok) {
+		// Append streams can report 0 until their first write on some runtimes, so find the end explicitly
+		ok = fseek(f, 0, SEEK_END) == 0;
+		if (ok && ftell(f) == 0)
+			ok = fwrite(STATS_MAGIC, 1, sizeof(STATS_MAGIC), f) == sizeof(STATS_MAGIC);
+		ok = ok && fwrite(runs, sizeof(StatsRun), count, f) == (size_t)count;
+		ok = statsClose(f) && ok;
+	}
+	if (!ok)
+		printf("Failed to write run log \"%s\"\n", gStats.logFile);
+
+	double highscore = atomic_load(&gStats.highscore);
+	bool beaten = false;
+	for (int i = 0; i < count; i++) {
+		if (runs[i].score > highscore) {
+			highscore = runs[i].score;
+			beaten = true;
+		}
+	}
+	if (beaten) {
+		atomic_store(&gStats.highscore, highscore);
+		if (!statsReplace(gStats.highscoreFile, &highscore, sizeof(double), NULL, 0))
+			printf("Failed to save highscore to \"%s\"\n", gStats.highscoreFile);
+	}
+}
+
+static void *statsThread(void *data) {
+	statsLoad();
+	while (true) {
+		StatsRun runs[STATS_QUEUE_SIZE];
+		int count = 0;
+		while (count < STATS_QUEUE_SIZE && statsPop(&runs[count]))
+			count++;
+		if (count > 0)
+			statsWrite(runs, count);
+
+		pthread_mutex_lock(&gStats.lock);
+		while (statsEmpty() && !gStats.quit)
+			pthread_cond_wait(&gStats.wake, &gStats.lock);
+		bool quit = gStats.quit && statsEmpty();
+		pthread_mutex_unlock(&gStats.lock);
+		if (quit)
+			break;
+	}
+	return NULL;
+}
+
+/********************* Stats functions *********************/
+void statsInit(const char *highscoreFile, const char *logFile) {
+	if (gStats.running)
+		return;
+	snprintf(gStats.highscoreFile, STATS_FILENAME_LENGTH, "%s", highscoreFile);
+	snprintf(gStats.logFile, STATS_FILENAME_LENGTH, "%s", logFile);
+	pthread_mutex_init(&gStats.lock, NULL);
+	pthread_cond_init(&gStats.wake, NULL);
+	gStats.quit = false;
+	gStats.running = pthread_create(&gStats.thread, NULL, statsThread, NULL) == 0;
+	if (!gStats.running) {
+		pthread_mutex_destroy(&gStats.lock);
+		pthread_cond_destroy(&gStats.wake);
+		printf("Failed to start the stats writer, runs won't be saved\n");
+	}
+}
+
+void statsFree() {
+	if (!gStats.running)
+		return;
+	pthread_mutex_lock(&gStats.lock);
+	gStats.quit = true;
+	pthread_cond_signal(&gStats.wake);
+	pthread_mutex_unlock(&gStats.lock);
+	pthread_join(gStats.thread, NULL);
+	pthread_mutex_destroy(&gStats.lock);
+	pthread_cond_destroy(&gStats.wake);
+	gStats.running = false;
+}
+
+bool statsSubmit(const StatsRun *run) {
+	if (!gStats.running)
+		return false;
+	unsigned int head = atomic_load_explicit(&gStats.head, memory_order_relaxed);
+	if (head - atomic_load_explicit(&gStats.tail, memory_order_acquire) >= STATS_QUEUE_SIZE)
+		return false;
+	gStats.queue[head & (STATS_QUEUE_SIZE - 1)] = *run;
+	atomic_store_explicit(&gStats.head, head + 1, memory_order_release);
+
+	// The writer only holds the lock to check if it should sleep, so this never waits on the disk
+	pthread_mutex_lock(&gStats.lock);
+	pthread_cond_signal(&gStats.wake);
+	pthread_mutex_unlock(&gStats.lock);
+	return true;
+}
+
+double statsHighscore() {
+	return atomic_load(&gStats.highscore);
+}
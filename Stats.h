@@ -0,0 +1,31 @@
+// Saves the highscore and a log of every run on a background thread so the game never waits on the disk
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/********************* Constants **********************/
+#define STATS_QUEUE_SIZE ((int)16) // Runs that can be waiting to be written, a power of 2
+
+/********************* Structs **********************/
+// One record of the log, laid out exactly as it is in the file after its "LECDRUN1" header
+typedef struct {
+	int64_t time;           // Unix time the run ended
+	double score;
+	uint32_t ticks;         // How long it lasted
+	uint32_t kills;
+	uint32_t trashDisposed;
+	uint32_t reserved;
+} StatsRun;
+
+/********************* Functions *********************/
+// Starts the writer, which loads the highscore from highscoreFile in the background and appends runs to logFile
+void statsInit(const char *highscoreFile, const char *logFile);
+
+// Writes whatever is still queued then stops the writer
+void statsFree();
+
+// Queues a run to be logged and saved as the highscore if it beats it, returns false if the queue is full
+bool statsSubmit(const StatsRun *run);
+
+// Best score loaded or submitted so far, 0 until the highscore has been loaded
+double statsHighscore();
@@ -0,0 +1,44 @@
+// Everything one game's simulation keeps, so any number of games can exist side by side
+#pragma once
+#include "Sim.h"
+#include "Spatial.h"
+#include "Field.h"
+
+/********************* Structs *********************/
+typedef struct {
+	PlayerEntity player;
+	EntityHandle garbageDisposal;
+	Population population;
+	SpatialHash spatial;  // Every live entity as of the end of the last tick
+	ForceField field;     // Gravity from every garbage disposal
+	SimView view;
+	SimView lastView;     // view at the start of the last tick
+	long ticks;           // Ticks since simStart
+	real score;
+	int kills;            // Drones knocked out since simStart
+	int trashDisposed;    // Trash put in the garbage disposal since simStart
+	real lastGarbageTime;
+	real lastEnemyTime;
+	int enemyCount;
+	int enemyMax;
+	real enemyCountLastTime;
+	int spawnDelay;
+	RandomStream random[RANDOM_STREAM_MAX];
+	bool lod;             // Put trash far from the player to sleep instead of stepping it, on unless turned off. Kept across simStart
+
+	// One buffer per chunk of the pass over the population currently running
+	SimCommandBuffer *commandBuffers;
+	int commandBufferCount;
+} SimWorld;
+
+/********************* Globals *********************/
+// World the simulation functions work on from this thread. Every thread starts out on the same default world
+// so programs that only ever run one game never have to set it
+extern _Thread_local SimWorld *gWorld;
+
+/********************* Functions *********************/
+// Makes a world with no game in it yet, simStart it while it's gWorld
+SimWorld *simWorldCreate();
+
+// Ends the game in the world if there is one and frees it, it can't be gWorld on any thread afterwards
+void simWorldFree(SimWorld *world);
@@ -2,208 +2,178 @@
 #include <SDL2/SDL.h>
 #include <VK2D/VK2D.h>
 #include <time.h>
+#include <stddef.h>
+#include "World.h"
+#include "Replay.h"
+#include "Snapshot.h"
+#include "Jobs.h"
+#include "Profile.h"
+#include "Pack.h"
+#include "Stats.h"
 
 #define ASSETS_IMPLEMENTATION
 #include "Assets.h"
 #include "JamUtil/JamUtil.h"
 
 /********************* Types *********************/
-typedef double real;
 typedef enum {
 	GAMESTATE_MENU = 0,
 	GAMESTATE_GAME = 1,
 	GAMESTATE_QUIT = 2,
 	GAMESTATE_MAX = 3,
 } gamestate;
+
 typedef enum {
-	ENTITY_TYPE_NONE = 0,
-	ENTITY_TYPE_PLAYER = 1,
-	ENTITY_TYPE_TRASH = 2,
-	ENTITY_TYPE_DRONE = 3,
-	ENTITY_TYPE_MINE = 4,
-	ENTITY_TYPE_GARBAGE_DISPOSAL = 5,
-	ENTITY_TYPE_MAX = 6,
-} entitytype;
+	SPRITE_PLAYER = 0,
+	SPRITE_PLAYER_THRUSTER = 1,
+	SPRITE_DRONE = 2,
+	SPRITE_MINE = 3,
+	SPRITE_TRASH1 = 4,
+	SPRITE_TRASH2 = 5,
+	SPRITE_ARROW = 6,
+	SPRITE_HP = 7,
+	SPRITE_MAX = 8,
+} spriteid;
 
 /********************* Constants **********************/
 const int   WINDOW_WIDTH     = 1024;
 const int   WINDOW_HEIGHT    = 768;
-const int   GAME_WIDTH       = 1500;
-const int   GAME_HEIGHT      = 1125;
-const real  FPS_LIMIT        = 60;
 const real  ZOOM_MIN         = 0.5;
 const real  ZOOM_MAX         = 2;
 const real  ZOOM_SPEED       = 0.25;
 const int   FONT_WIDTH       = 40;
 const int   FONT_HEIGHT      = 70;
-const float CAMERA_SPEED     = 0.2;
-const int   NO_TRASH         = -1;
 const bool  DEBUG            = false;
 const char  HIGHSCORE_FILE[] = "score.bin";
+const char  STATS_FILE[]     = "stats.bin"; // Log of every run
 const int   GAME_OVER_DELAY  = FPS_LIMIT * 3;
-
-const real WORLD_MAX_WIDTH  = 60000;
-const real WORLD_MAX_HEIGHT = 60000;
+const real  RENDER_FPS_LIMIT = 240;
+const int   MAX_FRAME_TICKS  = 5; // Past this many ticks in a frame the game slows down instead of falling further behind
+const char  TRACE_FILE[]     = "trace.json";
+#ifdef LECD_DEBUG_REWIND
+const int   REWIND_TICKS     = FPS_LIMIT * 5; // How far back holding R can go
+#endif
+const float PROFILE_OVERLAY_SCALE = 2.5; // Overlay text is drawn this many times smaller than normal text
+const char  ASSET_PACK_FILE[] = "assets/Assets.pak"; // Made by PackAssets.py, the loose files are loaded instead if it's missing
 
 const real SUN_POS_X = -600;
 const real SUN_POS_Y = -600;
 
-const real PLAYER_START_X = WORLD_MAX_WIDTH / 2;
-const real PLAYER_START_Y = WORLD_MAX_HEIGHT / 2;
-
-const real PLAYER_BASE_ROTATE_ACCELERATION  = VK2D_PI * 0.003;
-const real PLAYER_BASE_ROTATE_FRICTION      = VK2D_PI * 0.001;
-const real PLAYER_BASE_ROTATE_TOP_SPEED     = VK2D_PI * 0.02;
-const real PLAYER_BASE_TRASH_GRAB_DISTANCE  = 200;
-const real PLAYER_BASE_TRASH_THROW_SPEED    = 20; // MUST NOT BE IN THE RANGE OF [TRASH_MIN_VELOCITY, TRASH_MAX_VELOCITY]
-const real PLAYER_TRASH_DRAW_DISTANCE       = 200;
-const int  PLAYER_DAMAGED_IFRAMES           = FPS_LIMIT * 3;
 const int  PLAYER_DAMAGED_BLINKING_INTERVAL = 10;
-const real PLAYER_BASE_ACCELERATION         = 0.15;
-const real PLAYER_FRICTION                  = 0.02;
-const real PLAYER_BASE_HP                   = 5;
-const real PLAYER_DYING_ROTATE_SPEED        = VK2D_PI * 0.05;
-
-const real PHYSICS_BASE_TOP_SPEED = 15;
-
-const real TRASH_MIN_VELOCITY              = 2;
-const real TRASH_MAX_VELOCITY              = 10;
-const real TRASH_MIN_ROT_SPEED             = VK2D_PI * 0.01;
-const real TRASH_MAX_ROT_SPEED             = VK2D_PI * 0.03;
-const real TRASH_PLAYER_DIRECTION_ACCURACY = VK2D_PI * 0.1;
-const int  TRASH_LIFETIME                  = FPS_LIMIT * 15;
-const int  TRASH_FADE_OUT_TIME             = FPS_LIMIT * 3;
-const real TRASH_SPAWN_DISTANCE            = 1000;
-#define    TRASH_MAX                         ((int)4000)
-const real TRASH_SPAWN_INTERVAL            = 0.3; // trash spawns every TRASH_SPAWN_INTERVAL seconds
-const real TRASH_MIN_VALUE                 = 0.15;
-const real TRASH_MAX_VALUE                 = 2;
-
-const real DRONE_BASE_ACCELERATION        = 0.15;
-const int  DRONE_DYING_TIMER              = FPS_LIMIT * 3;
-const real DRONE_DYING_ROTATE_SPEED       = VK2D_PI * 0.05;
-const real DRONE_TRASH_COLLISION_DISTANCE = 100;
-const real DRONE_SPAWN_DISTANCE           = 2000;
-const real DRONE_DYING_SPEED              = 3;
-const real DRONE_DAMAGE_RADIUS            = 150;
-const real DRONE_SPAWN_INTERVAL           = 10; // trash spawns every TRASH_SPAWN_INTERVAL seconds
-const real DRONE_MAX_INTERVAL             = 50; // how many seconds between the max number of enemies increases
-const int  DRONE_SPAWN_DELAY              = FPS_LIMIT * 15; // dont start spawning enemies until this far in
-const real DRONE_FIGHTER_CHANCE           = 0.3; // chance for a drone to be a fighter drone
-
-const real GARBAGE_DISPOSAL_START_X        = PLAYER_START_X + 1000;
-const real GARBAGE_DISPOSAL_START_Y        = PLAYER_START_Y;
-const real GARBAGE_DISPOSAL_GRAVITY_RADIUS = 800;
-const real GARBAGE_DISPOSAL_GRAB_RADIUS    = 100;
-const real GARBAGE_DISPOSAL_GRAVITY        = 0.8;
-const real GARBAGE_DISPOSAL_WIDTH          = 100;
-const real GARBAGE_DISPOSAL_HEIGHT         = 100;
-
-/********************* Structs **********************/
-
-// Physics vector
-typedef struct {
-	real magnitude; // Pixels
-	real direction; // Radians
-} Vector;
 
-// Physics physics simulation
-typedef struct {
-	real x;
-	real y;
-	Vector velocity;
-	real mass; // Kilograms
-} Physics;
-
-typedef struct {
-	real dirVelocity;
-	real direction;
-	int grabbedTrash; // Index of the grabbed trash
-	real hp;
-	int iframes; // iframes left after getting damaged
-} Player;
-
-typedef struct {
-	VK2DTexture tex;
-	int framesLeftAlive;
-	real rot;
-	real rotSpeed;
-	bool grabbed;
-	bool trashAnimation;
-	bool wasThrown;
-} Trash;
-
-typedef struct {
-	bool dying;
-	int dyingTimer;
-	real dyingRotation;
-	bool fighter;
-} Drone;
+const real GARBAGE_DISPOSAL_WIDTH  = 100;
+const real GARBAGE_DISPOSAL_HEIGHT = 100;
+const real GARBAGE_DISPOSAL_SWING  = 0.5; // The model swings between plus and minus this many radians
+#define GARBAGE_DISPOSAL_FRAMES 32        // Rotations of the model baked ahead of time, the nearest one gets drawn
 
+/********************* Types *********************/
+// Where a texture from the asset archive goes in Assets
 typedef struct {
-	// frig
-} GarbageDisposal;
-
-// Any kind of entity in the world
+	const char *name;
+	size_t offset;
+} PackedTexture;
+
+// Textures that aren't sprites, the font loads its own copy of Font.png
+const PackedTexture PACKED_TEXTURES[] = {
+	{"assets/Background.png", offsetof(Assets, texBackground)},
+	{"assets/Foreground.png", offsetof(Assets, texForeground)},
+	{"assets/GarbageDisposal.png", offsetof(Assets, texGarbageDisposal)},
+	{"assets/Midground.png", offsetof(Assets, texMidground)},
+	{"assets/Sun.png", offsetof(Assets, texSun)},
+	{"assets/title.png", offsetof(Assets, textitle)},
+};
+#define PACKED_TEXTURE_COUNT (sizeof(PACKED_TEXTURES) / sizeof(PackedTexture))
+
+// Where each sprite comes from, packed sprites are all part of the atlas and loose ones use their Assets texture
+const PackedTexture SPRITE_SOURCES[SPRITE_MAX] = {
+	{"assets/Player.png", offsetof(Assets, texPlayer)},
+	{"assets/PlayerThruster.png", offsetof(Assets, texPlayerThruster)},
+	{"assets/Drone.png", offsetof(Assets, texDrone)},
+	{"assets/Mine.png", offsetof(Assets, texMine)},
+	{"assets/Trash1.png", offsetof(Assets, texTrash1)},
+	{"assets/Trash2.png", offsetof(Assets, texTrash2)},
+	{"assets/Arrow.png", offsetof(Assets, texArrow)},
+	{"assets/HP.png", offsetof(Assets, texHP)},
+};
+
+#define TEXT_RUN_LENGTH 64
+#define FONT_FIRST_CHARACTER 32 // gFont covers [FONT_FIRST_CHARACTER, FONT_LAST_CHARACTER)
+#define FONT_LAST_CHARACTER 128
+
+// Text laid out once as instances of the font's glyphs, it's only laid out again when the text changes
 typedef struct {
-	entitytype type; // entities can delete themselves by setting this to ENTITY_TYPE_NONE
-	Physics physics;
-	union {
-		Player player;
-		Trash trash;
-		Drone drone;
-		GarbageDisposal garbageDisposal;
-	};
-} Entity;
-
-// All entities in the game
+	char text[TEXT_RUN_LENGTH];
+	VK2DDrawInstance glyphs[TEXT_RUN_LENGTH];
+	int count;
+	float width;
+	float x;             // Where the glyphs are laid out at the moment
+	float y;
+	const char *format;  // Format and value of the last textRunSetValue, to skip formatting an unchanged value
+	double value;
+} TextRun;
+
+// Part of a texture, sprites that share a texture can be drawn together
 typedef struct {
-	Entity *entities; // Vector of entities
-	int size;         // Number of entities in the game
-} Population;
+	VK2DTexture texture;
+	float x;
+	float y;
+	float w;
+	float h;
+} Sprite;
 
 /********************* Globals *********************/
 Assets *gAssets = NULL;
 VK2DCameraIndex gCam = -1;
 VK2DCameraIndex g3DCam = -1;
-Entity gPlayer = {ENTITY_TYPE_PLAYER};
-int gGarbageDisposal = -1;
 real gZoom = 1;
 JUFont gFont = NULL;
-Population gPopulation = {};
-real gScore = 0;
 VK2DModel gGarbageModel;
-real gLastGarbageTime = 0;
-real gLastEnemyTime = 0;
-int gEnemyCount;
-int gEnemyMax = 1;
-real gEnemyCountLastTime = 0;
 VK2DShader gShader = NULL;
-int gSpawnDelay = 0;
 real gHighscore = 0;
 bool gNewHighscore = false;
 int gGameoverDelay = 0;
-VK2DTexture gGarbageDisposalTexture;
-
-// Expirimental
-VK2DDrawInstance gEntityBuffer1[TRASH_MAX];
-VK2DDrawInstance gEntityBuffer2[TRASH_MAX];
-VK2DDrawInstance *gEntityBuffers[] = {gEntityBuffer1, gEntityBuffer2};
+VK2DTexture gGarbageDisposalTexture;                           // Model rendered live every frame
+VK2DTexture gGarbageDisposalFrames[GARBAGE_DISPOSAL_FRAMES];   // Model rendered at evenly spaced rotations across the swing
+bool gGarbageDisposalBaked[GARBAGE_DISPOSAL_FRAMES];           // Frames are only rendered the first time they're needed
+bool gGarbageDisposalLive = false;                             // Render the model every frame instead of using the baked frames
+VK2DTexture gGarbageDisposalCurrent;                           // Texture the disposal gets drawn with this frame
+PlayerInput gInput = {};
+double gTickAccumulator = 0; // Seconds of simulation owed since the last tick
+real gBlend = 1;             // How far between the last tick and the current one to draw things, [0, 1]
+Replay gReplay = {};
+const char *gRecordFile = NULL; // Games are recorded to this if set
+const char *gReplayFile = NULL; // Games play this recording back instead of reading the keyboard if set
+bool gReplayDiverged = false;
+#ifdef LECD_DEBUG_REWIND
+SnapshotRing gRewind = {};
+#endif
+VK2DCameraIndex gOverlayCam = -1;
+TextRun gTextPrompt = {};
+TextRun gTextHighscore = {};
+TextRun gTextScore = {};
+TextRun gTextFired = {};
+TextRun gTextNewHighscore = {};
+bool gProfileOverlay = false;
+
+// Entity instances for the current frame, alternates every frame so filling one can overlap with the GPU reading the other.
+// Each flush submits the instances after the last one's, so nothing a draw was given is written over that frame
+VK2DDrawInstance *gEntityBuffers[2] = {NULL, NULL};
+int gEntityBufferCapacity[2] = {0, 0};
+int gEntityBufferIndex = 0;
+int gEntityBufferStart = 0; // Where the instances queued since the last flush begin
+int gEntityBufferCount = 0;
+VK2DTexture gEntityBufferTexture = NULL;
+VK2DCameraSpec gCullView; // What the game camera sees this frame, entities outside of it aren't drawn
+Pack gPack = {};                                // Asset archive, mapped for as long as the game runs if it was found
+VK2DImage gPackImages[PACKED_TEXTURE_COUNT];    // What the packed textures were made from, textures don't free them
+VK2DImage gAtlasImage = NULL;
+VK2DTexture gAtlas = NULL;                      // Every sprite when loaded from the archive
+Sprite gSprites[SPRITE_MAX];
 
 /********************* Common functions *********************/
-// Returns a real from 0-1
-real random() {
-	return (real)(rand() % 1000) / 1000.0;
-}
-
-// Returns an int from [low, high)
-int randomRange(int low, int high) {
-	return low + (int)floor(random() * (high - low));
-}
-
-// Returns a real number from low to high
-real randomRangeReal(real low, real high) {
-	return low + (random() * (high - low));
+// Where something is between the last tick and the current one
+float blend(real last, real current) {
+	return last + ((current - last) * gBlend);
 }
 
 void drawTiledBackground(VK2DTexture texture, float rate) {
@@ -225,460 +195,384 @@ void drawTiledBackground(VK2DTexture texture, float rate) {
 			vk2dDrawTexture(texture, tileStartX + (x * vk2dTextureWidth(texture)), tileStartY + (y * vk2dTextureHeight(texture)));
 }
 
-/********************* Physics functions *********************/
-void physicsStart(Physics *physics, real x, real y) {
-	physics->x = x;
-	physics->y = y;
-	physics->velocity.magnitude = 0;
-	physics->velocity.direction = 0;
-}
-
-void physicsUpdate(Physics *physics, Vector *acceleration) {
-	if (acceleration != NULL) {
-		// Add acceleration vector to the velocity vector then cap velocity
-		real rise = (sin(acceleration->direction) * acceleration->magnitude) + (sin(physics->velocity.direction) * physics->velocity.magnitude);
-		real run = (cos(acceleration->direction) * acceleration->magnitude) + (cos(physics->velocity.direction) * physics->velocity.magnitude);
-		physics->velocity.direction = run == 0 ? 0 : atan2(rise, run);
-		physics->velocity.magnitude = sqrt(pow(rise, 2) + pow(run, 2));
-		physics->velocity.magnitude = juClamp(physics->velocity.magnitude, -PHYSICS_BASE_TOP_SPEED, PHYSICS_BASE_TOP_SPEED);
+/********************* Asset functions *********************/
+// Loads all assets from the archive, the pixels are already decoded so they go straight to the GPU. Returns NULL if
+// there is no usable archive so the loose files can be loaded instead.
+Assets *packBuildAssets() {
+	if (!packOpen(&gPack, ASSET_PACK_FILE))
+		return NULL;
+	const PackEntry *model = packFind(&gPack, "assets/GarbageDisposal.obj");
+	PackMesh mesh;
+	bool ok = model != NULL && packMesh(&gPack, model, &mesh) && packFind(&gPack, "assets/tex.vert.spv") != NULL && packFind(&gPack, "assets/tex.frag.spv") != NULL;
+	for (int i = 0; ok && i < PACKED_TEXTURE_COUNT; i++) {
+		const PackEntry *entry = packFind(&gPack, PACKED_TEXTURES[i].name);
+		ok = entry != NULL && entry->type == PACK_ENTRY_PIXELS;
 	}
-
-	// Apply velocity to coordinates then cap coordinates
-	physics->x += juCastX(physics->velocity.magnitude, -physics->velocity.direction);
-	physics->y += juCastY(physics->velocity.magnitude, -physics->velocity.direction);
-	physics->x = juClamp(physics->x, 0, WORLD_MAX_WIDTH);
-	physics->y = juClamp(physics->y, 0, WORLD_MAX_HEIGHT);
-}
-
-Vector addVectors(Vector *v1, Vector *v2) {
-	real rise = (sin(v2->direction) * v2->magnitude) + (sin(v1->direction) * v1->magnitude);
-	real run = (cos(v2->direction) * v2->magnitude) + (cos(v1->direction) * v1->magnitude);
-	v1->direction = run == 0 ? 0 : atan2(rise, run);
-	v1->magnitude = sqrt(pow(rise, 2) + pow(run, 2));
-	v1->magnitude = juClamp(v1->magnitude, -PHYSICS_BASE_TOP_SPEED, PHYSICS_BASE_TOP_SPEED);
-}
-
-/********************* Trash functions *********************/
-void trashStart(Entity *entity) {
-	VK2DTexture tex[] = {gAssets->texTrash1, gAssets->texTrash2};
-	entity->type = ENTITY_TYPE_TRASH;
-	entity->trash.tex = tex[randomRange(0, 2)];
-	entity->trash.rotSpeed = randomRangeReal(TRASH_MIN_ROT_SPEED, TRASH_MAX_ROT_SPEED);
-	entity->trash.rot = 0;
-	entity->trash.framesLeftAlive = TRASH_LIFETIME;
-	entity->trash.grabbed = false;
-	entity->trash.trashAnimation = false;
-	entity->trash.wasThrown = false;
-
-	// Physics
-	VK2DCameraSpec spec = vk2dCameraGetSpec(gCam);
-	if (randomRange(0, 2)) { // Left/right of the screen
-		entity->physics.x = randomRange(0, 2) ? spec.x - TRASH_SPAWN_DISTANCE : spec.x + spec.w + TRASH_SPAWN_DISTANCE;
-		entity->physics.y = randomRangeReal(spec.y, spec.y + spec.h);
-	} else { // Top/bottom of the screen
-		entity->physics.x = randomRangeReal(spec.x, spec.x + spec.w);
-		entity->physics.y = randomRange(0, 2) ? spec.y - TRASH_SPAWN_DISTANCE : spec.y + spec.h + TRASH_SPAWN_DISTANCE;
-	}
-	real angle = juPointAngle(gPlayer.physics.x, gPlayer.physics.y, entity->physics.x, entity->physics.y);// - (VK2D_PI / 2);
-	entity->physics.velocity.direction = randomRangeReal(angle - TRASH_PLAYER_DIRECTION_ACCURACY, angle + TRASH_PLAYER_DIRECTION_ACCURACY);
-	entity->physics.velocity.magnitude = randomRangeReal(TRASH_MIN_VELOCITY, TRASH_MAX_VELOCITY);
-}
-
-void trashEnd(Entity *entity) {
-	entity->type = ENTITY_TYPE_NONE; // carted
-}
-
-void droneEnd(Entity *entity);
-void trashUpdate(Entity *entity) {
-	Entity *garbage = &gPopulation.entities[gGarbageDisposal];
-	real dist = juPointDistance(entity->physics.x, entity->physics.y, garbage->physics.x, garbage->physics.y);
-
-	// Updating
-	if (!entity->trash.grabbed) {
-		if (dist > GARBAGE_DISPOSAL_GRAB_RADIUS && dist < GARBAGE_DISPOSAL_GRAVITY_RADIUS && entity->trash.wasThrown) {
-			real angle = (VK2D_PI / 2) - juPointAngle(entity->physics.x, entity->physics.y, garbage->physics.x, garbage->physics.y) - (VK2D_PI / 2);
-			real speed = GARBAGE_DISPOSAL_GRAVITY;
-			Vector gravity;
-			gravity.direction = angle;
-			gravity.magnitude = speed;
-			physicsUpdate(&entity->physics, &gravity);
-		} else if (dist < GARBAGE_DISPOSAL_GRAB_RADIUS && entity->trash.wasThrown && !entity->trash.trashAnimation) {
-			// Start the garbage spin animation
-			entity->trash.trashAnimation = true;
-			gScore += randomRangeReal(TRASH_MIN_VALUE, TRASH_MAX_VALUE);
-			entity->trash.framesLeftAlive = TRASH_FADE_OUT_TIME;
-		} else {
-			physicsUpdate(&entity->physics, NULL);
-		}
-		entity->trash.rot += entity->trash.rotSpeed;
-		entity->trash.framesLeftAlive -= 1;
-		if (entity->trash.framesLeftAlive <= 0)
-			trashEnd(entity);
-	} else {
-		entity->trash.framesLeftAlive = TRASH_LIFETIME;
+	const PackEntry *atlas = packFind(&gPack, PACK_ATLAS_NAME);
+	ok = ok && atlas != NULL && atlas->type == PACK_ENTRY_PIXELS;
+	for (int i = 0; ok && i < SPRITE_MAX; i++) {
+		const PackEntry *entry = packFind(&gPack, SPRITE_SOURCES[i].name);
+		uint32_t x, y;
+		ok = entry != NULL && packSprite(&gPack, entry, &x, &y) && x + entry->width <= atlas->width && y + entry->height <= atlas->height;
 	}
-
-	// If the trash is in the dying animation just spin out in the garbage disposal
-	if (entity->trash.trashAnimation) {
-		entity->physics.x = garbage->physics.x;
-		entity->physics.y = garbage->physics.y;
+	if (!ok) {
+		printf("\"%s\" is out of date, loading loose assets instead\n", ASSET_PACK_FILE);
+		packClose(&gPack);
+		return NULL;
 	}
 
-	// Check if we were thrown and as such check if we hit any enemies
-	if (entity->trash.wasThrown) {
-		for (int i = 0; i < gPopulation.size && entity->physics.velocity.magnitude == PLAYER_BASE_TRASH_THROW_SPEED; i++) {
-			Entity *drone = &gPopulation.entities[i];
-			if (drone->type == ENTITY_TYPE_DRONE && !drone->drone.dying && juPointDistance(entity->physics.x, entity->physics.y, drone->physics.x, drone->physics.y) < DRONE_TRASH_COLLISION_DISTANCE) {
-				droneEnd(drone);
-				drone->physics.velocity = entity->physics.velocity;
-				drone->physics.velocity.magnitude = DRONE_DYING_SPEED;
-				entity->physics.velocity.magnitude /= 2;
-			}
-		}
+	Assets *s = calloc(1, sizeof(struct Assets));
+	for (int i = 0; i < PACKED_TEXTURE_COUNT; i++) {
+		const PackEntry *entry = packFind(&gPack, PACKED_TEXTURES[i].name);
+		gPackImages[i] = vk2dImageFromPixels(vk2dRendererGetDevice(), (void*)packData(&gPack, entry), entry->width, entry->height);
+		*(VK2DTexture*)((char*)s + PACKED_TEXTURES[i].offset) = vk2dTextureLoadFromImage(gPackImages[i]);
 	}
 
-	// Drawing
-	vec4 alpha = {1, 1, 1, 1};
-	if (entity->trash.framesLeftAlive <= TRASH_FADE_OUT_TIME)
-		alpha[3] = (float)entity->trash.framesLeftAlive / (float)TRASH_FADE_OUT_TIME;
-	float drawOriginX = (vk2dTextureWidth(entity->trash.tex) / 2) - ((1 - alpha[3]) * (vk2dTextureWidth(entity->trash.tex) / 2));
-	float drawOriginY = (vk2dTextureHeight(entity->trash.tex) / 2) - ((1 - alpha[3]) * (vk2dTextureHeight(entity->trash.tex) / 2));
-	float originX = (vk2dTextureWidth(entity->trash.tex) / 2);
-	float originY = (vk2dTextureHeight(entity->trash.tex) / 2);
-	vk2dRendererSetColourMod(alpha);
-	vk2dDrawTextureExt(entity->trash.tex, entity->physics.x - drawOriginX, entity->physics.y - drawOriginY, alpha[3], alpha[3], entity->trash.rot, originX, originY);
-	vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
-
-	if (DEBUG) {
-		vk2dDrawCircle(entity->physics.x, entity->physics.y, 4);
+	// Sprites get left out of Assets, they're only drawn through gSprites
+	gAtlasImage = vk2dImageFromPixels(vk2dRendererGetDevice(), (void*)packData(&gPack, atlas), atlas->width, atlas->height);
+	gAtlas = vk2dTextureLoadFromImage(gAtlasImage);
+	for (int i = 0; i < SPRITE_MAX; i++) {
+		const PackEntry *entry = packFind(&gPack, SPRITE_SOURCES[i].name);
+		uint32_t x, y;
+		packSprite(&gPack, entry, &x, &y);
+		Sprite sprite = {gAtlas, x, y, entry->width, entry->height};
+		gSprites[i] = sprite;
 	}
+	return s;
 }
 
-/********************* Drone functions *********************/
-void playerTakeDamage(Entity *entity);
-void droneStart(Entity *entity) {
-	// Zero entity
-	memset(entity, 0, sizeof(Entity));
-	entity->type = ENTITY_TYPE_DRONE;
-	gEnemyCount++;
-	entity->drone.fighter = randomRangeReal(0, 1) < DRONE_FIGHTER_CHANCE;
-
-	// Spawn off screen
-	VK2DCameraSpec spec = vk2dCameraGetSpec(gCam);
-	if (randomRange(0, 2)) { // Left/right of the screen
-		entity->physics.x = randomRange(0, 2) ? spec.x - DRONE_SPAWN_DISTANCE : spec.x + spec.w + DRONE_SPAWN_DISTANCE;
-		entity->physics.y = randomRangeReal(spec.y, spec.y + spec.h);
-	} else { // Top/bottom of the screen
-		entity->physics.x = randomRangeReal(spec.x, spec.x + spec.w);
-		entity->physics.y = randomRange(0, 2) ? spec.y - DRONE_SPAWN_DISTANCE : spec.y + spec.h + DRONE_SPAWN_DISTANCE;
+// Sprites for when the assets were loaded from loose files, each one is all of its own texture
+void spritesFromAssets(Assets *s) {
+	for (int i = 0; i < SPRITE_MAX; i++) {
+		VK2DTexture texture = *(VK2DTexture*)((char*)s + SPRITE_SOURCES[i].offset);
+		Sprite sprite = {texture, 0, 0, vk2dTextureWidth(texture), vk2dTextureHeight(texture)};
+		gSprites[i] = sprite;
 	}
 }
 
-void droneEnd(Entity *entity) {
-	entity->drone.dying = true;
-	entity->drone.dyingTimer = DRONE_DYING_TIMER;
-	gEnemyCount--;
+void drawSprite(const Sprite *sprite, float x, float y, float xScale, float yScale, float rot, float originX, float originY) {
+	vk2dDrawTexturePartExt(sprite->texture, x, y, sprite->x, sprite->y, sprite->w, sprite->h, xScale, yScale, rot, originX, originY);
 }
 
-void droneUpdate(Entity *entity) {
-	float originX = vk2dTextureWidth(gAssets->texDrone) / 2;
-	float originY = vk2dTextureHeight(gAssets->texDrone) / 2;
-	if (!entity->drone.dying) {
-		// Accelerate towards the player
-		Vector acceleration = {DRONE_BASE_ACCELERATION, (VK2D_PI / 2) - juPointAngle(entity->physics.x, entity->physics.y, gPlayer.physics.x, gPlayer.physics.y) - (VK2D_PI / 2)};
-		if (!entity->drone.fighter) {
-			physicsUpdate(&entity->physics, &acceleration);
-		} else {
-			float dir = juPointAngle(entity->physics.x, entity->physics.y, gPlayer.physics.x, gPlayer.physics.y);
-			entity->physics.x += juCastX(PHYSICS_BASE_TOP_SPEED * 0.75, dir);
-			entity->physics.y += juCastY(PHYSICS_BASE_TOP_SPEED * 0.75, dir);
-			entity->physics.velocity.direction = acceleration.direction;
-		}
-
-		// Check if we're damaging the player
-		if (juPointDistance(entity->physics.x, entity->physics.y, gPlayer.physics.x, gPlayer.physics.y) <= DRONE_DAMAGE_RADIUS) {
-			playerTakeDamage(entity);
-			entity->physics.velocity.direction += VK2D_PI;
-			entity->physics.velocity.magnitude *= 0.5;
-		}
+// Builds the garbage disposal model from its packed mesh, vertices are packed the same as VK2DVertex3D
+VK2DModel packBuildModel(const char *name, VK2DTexture texture) {
+	_Static_assert(sizeof(VK2DVertex3D) == sizeof(float) * 5, "Packed meshes must match VK2DVertex3D");
+	PackMesh mesh;
+	packMesh(&gPack, packFind(&gPack, name), &mesh);
+	return vk2dModelCreate((const VK2DVertex3D*)mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount, texture);
+}
 
-		// Draw
-		if (entity->drone.fighter) {
-			vec4 c;
-			vk2dColourHex(c, "#20326e");
-			vk2dRendererSetColourMod(c);
-		}
-		vk2dDrawTextureExt(gAssets->texDrone, entity->physics.x - originX, entity->physics.y - originY, 1, 1, entity->physics.velocity.direction, originX, originY);
-		vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
+VK2DShader packBuildShader(const char *vertex, const char *fragment, uint32_t uniformBufferSize) {
+	const PackEntry *vertexEntry = packFind(&gPack, vertex);
+	const PackEntry *fragmentEntry = packFind(&gPack, fragment);
+	return vk2dShaderFrom((uint8_t*)packData(&gPack, vertexEntry), vertexEntry->size, (uint8_t*)packData(&gPack, fragmentEntry), fragmentEntry->size, uniformBufferSize);
+}
 
-		if (DEBUG) {
-			vk2dDrawCircleOutline(entity->physics.x, entity->physics.y, DRONE_DAMAGE_RADIUS, 1);
-			vk2dDrawCircle(entity->physics.x, entity->physics.y, 4);
+void packDestroyAssets(Assets *s) {
+	for (int i = 0; i < PACKED_TEXTURE_COUNT; i++) {
+		vk2dTextureFree(*(VK2DTexture*)((char*)s + PACKED_TEXTURES[i].offset));
+		vk2dImageFree(gPackImages[i]);
+	}
+	vk2dTextureFree(gAtlas);
+	vk2dImageFree(gAtlasImage);
+	free(s);
+	packClose(&gPack);
+}
+
+/********************* Text functions *********************/
+// Lays the text out in a line from (0, 0) if it's different from what's there
+void textRunSet(TextRun *run, const char *text) {
+	if (run->count > 0 && strcmp(run->text, text) == 0)
+		return;
+	vec4 colour = {1, 1, 1, 1};
+	run->count = 0;
+	run->width = 0;
+	run->x = 0;
+	run->y = 0;
+	run->format = NULL;
+	int length = 0;
+	for (; text[length] != 0 && length < TEXT_RUN_LENGTH - 1; length++) {
+		unsigned char c = text[length];
+		if (c < FONT_FIRST_CHARACTER || c >= FONT_LAST_CHARACTER)
+			continue;
+		JUCharacter *character = &gFont->characters[c - FONT_FIRST_CHARACTER];
+		VK2DDrawInstance *glyph = &run->glyphs[run->count++];
+		vk2dInstanceSet(glyph, run->width, 0, 1, 1, 0, 0, 0);
+		vk2dInstanceSetTextureInfo(glyph, character->x, character->y, character->w, character->h);
+		vk2dInstanceSetColour(glyph, colour);
+		run->width += character->w;
+	}
+	memcpy(run->text, text, length);
+	run->text[length] = 0;
+}
+
+// Formats value into the run only when it's changed since the last time
+void textRunSetValue(TextRun *run, const char *format, double value) {
+	if (run->count > 0 && run->format == format && run->value == value)
+		return;
+	char text[TEXT_RUN_LENGTH];
+	snprintf(text, TEXT_RUN_LENGTH, format, value);
+	textRunSet(run, text);
+	run->format = format;
+	run->value = value;
+}
+
+// Draws every glyph in one call, they only get moved if the run is drawn somewhere new
+void textRunDraw(TextRun *run, float x, float y) {
+	if (x != run->x || y != run->y) {
+		for (int i = 0; i < run->count; i++) {
+			VK2DDrawInstance *glyph = &run->glyphs[i];
+			vk2dInstanceSet(glyph, glyph->pos[0] + (x - run->x), glyph->pos[1] + (y - run->y), 1, 1, 0, 0, 0);
 		}
-	} else {
-		// Dying animation
-		physicsUpdate(&entity->physics, NULL);
-		entity->drone.dyingTimer -= 1;
-		entity->drone.dyingRotation += DRONE_DYING_ROTATE_SPEED;
-		float scale = (float)entity->drone.dyingTimer / (float)DRONE_DYING_TIMER;
-		vk2dDrawTextureExt(gAssets->texDrone, entity->physics.x - originX, entity->physics.y - originY, scale, scale, entity->drone.dyingRotation, originX, originY);
-
-		// Delete drone when animation is done
-		if (entity->drone.dyingTimer <= 0)
-			entity->type = ENTITY_TYPE_NONE;
+		run->x = x;
+		run->y = y;
 	}
+	if (run->count > 0)
+		vk2dDrawInstanced(gFont->bitmap, run->glyphs, run->count);
 }
 
-/********************* Mine functions *********************/
-void mineStart(Entity *entity) {
-	memset(entity, 0, sizeof(Entity));
-	entity->type = ENTITY_TYPE_MINE;
-	physicsStart(&entity->physics, 0, 0);
+/********************* Culling functions *********************/
+// Sprites are rotated and scaled around their origin, so anywhere they can reach fits in a circle around it
+float cullRadius(const Sprite *sprite, float scale) {
+	return sqrtf((sprite->w * sprite->w) + (sprite->h * sprite->h)) * 0.5 * fabsf(scale);
 }
 
-void mineUpdate(Entity *entity) {
-
+// Whether any of a circle is on screen
+bool cullVisible(float x, float y, float radius) {
+	return x + radius >= gCullView.x && x - radius <= gCullView.x + gCullView.w &&
+		   y + radius >= gCullView.y && y - radius <= gCullView.y + gCullView.h;
 }
 
-void mineEnd(Entity *entity) {
+/********************* Instance functions *********************/
+// Submits everything queued since the last flush in one draw
+void instanceFlush() {
+	if (gEntityBufferCount > 0)
+		vk2dDrawInstanced(gEntityBufferTexture, gEntityBuffers[gEntityBufferIndex] + gEntityBufferStart, gEntityBufferCount);
+	gEntityBufferStart += gEntityBufferCount;
+	gEntityBufferCount = 0;
+}
 
+// Swaps to the other buffer and makes room for count instances, call once per frame before queueing anything.
+// Whatever the buffer held was drawn two frames ago so it's safe to grow
+void instanceBeginFrame(int count) {
+	gEntityBufferIndex = (gEntityBufferIndex + 1) % 2;
+	if (count > gEntityBufferCapacity[gEntityBufferIndex]) {
+		gEntityBufferCapacity[gEntityBufferIndex] = count;
+		gEntityBuffers[gEntityBufferIndex] = realloc(gEntityBuffers[gEntityBufferIndex], count * sizeof(VK2DDrawInstance));
+	}
+	gEntityBufferStart = 0;
+	gEntityBufferCount = 0;
+	gEntityBufferTexture = NULL;
 }
 
-/********************* Garbage disposal functions *********************/
-void garbageDisposalStart(Entity *entity) {
-	memset(entity, 0, sizeof(Entity));
-	entity->type = ENTITY_TYPE_GARBAGE_DISPOSAL;
-	physicsStart(&entity->physics, GARBAGE_DISPOSAL_START_X, GARBAGE_DISPOSAL_START_Y);
+// Queues a sprite draw, same parameters as drawSprite plus a colour mod, at most as many as instanceBeginFrame made room for
+void instanceDraw(const Sprite *sprite, float x, float y, float xScale, float yScale, float rot, float originX, float originY, vec4 colour) {
+	// Different textures can't share a draw
+	if (sprite->texture != gEntityBufferTexture) {
+		instanceFlush();
+		gEntityBufferTexture = sprite->texture;
+	}
+	VK2DDrawInstance *instance = &gEntityBuffers[gEntityBufferIndex][gEntityBufferStart + gEntityBufferCount++];
+	vk2dInstanceSet(instance, x, y, xScale, yScale, rot, originX, originY);
+	vk2dInstanceSetTextureInfo(instance, sprite->x, sprite->y, sprite->w, sprite->h);
+	vk2dInstanceSetColour(instance, colour);
 }
 
-void garbageDisposalUpdate(Entity *entity) {
-	float scale = 6;
-	vk2dDrawTextureExt(gGarbageDisposalTexture, entity->physics.x - ((vk2dTextureWidth(gGarbageDisposalTexture) * scale) / 2), entity->physics.y - ((vk2dTextureHeight(gGarbageDisposalTexture) * scale) / 2), scale, scale, 0, 0, 0);
+/********************* Trash functions *********************/
+// Returns false if it was off screen and not drawn
+bool trashDraw(int i) {
+	TrashPool *trash = &gWorld->population.trash;
+	const Sprite *sprite = &gSprites[SPRITE_TRASH1 + trash->variant[i]];
+	vec4 alpha = {1, 1, 1, 1};
+	if (trash->framesLeftAlive[i] <= TRASH_FADE_OUT_TIME)
+		alpha[3] = (float)trash->framesLeftAlive[i] / (float)TRASH_FADE_OUT_TIME;
+	float drawOriginX = (sprite->w / 2) - ((1 - alpha[3]) * (sprite->w / 2));
+	float drawOriginY = (sprite->h / 2) - ((1 - alpha[3]) * (sprite->h / 2));
+	float originX = (sprite->w / 2);
+	float originY = (sprite->h / 2);
+	float x = blend(trash->lastX[i], trash->x[i]);
+	float y = blend(trash->lastY[i], trash->y[i]);
+	// Fading trash shrinks but its draw position moves with it, so a fading sprite stays inside the full size one
+	// around the pivot, which is what gets tested
+	if (!cullVisible(x - drawOriginX + originX, y - drawOriginY + originY, cullRadius(sprite, 1)))
+		return false;
+	instanceDraw(sprite, x - drawOriginX, y - drawOriginY, alpha[3], alpha[3], trash->rot[i], originX, originY, alpha);
+	return true;
+}
 
-	if (DEBUG) {
-		vk2dDrawCircle(entity->physics.x, entity->physics.y, 4);
-		vk2dDrawCircleOutline(entity->physics.x, entity->physics.y, GARBAGE_DISPOSAL_GRAVITY_RADIUS, 1);
-		vk2dDrawCircleOutline(entity->physics.x, entity->physics.y, GARBAGE_DISPOSAL_GRAB_RADIUS, 1);
+/********************* Drone functions *********************/
+// Returns false if it was off screen and not drawn
+bool droneDraw(int i) {
+	DronePool *drones = &gWorld->population.drones;
+	const Sprite *sprite = &gSprites[SPRITE_DRONE];
+	float originX = sprite->w / 2;
+	float originY = sprite->h / 2;
+	float x = blend(drones->lastX[i], drones->x[i]);
+	float y = blend(drones->lastY[i], drones->y[i]);
+	if (!cullVisible(x, y, cullRadius(sprite, 1)))
+		return false;
+	vec4 colour = {1, 1, 1, 1};
+	if (!drones->dying[i]) {
+		// Fighters face the player, everything else faces where it's going
+		float heading = drones->fighter[i] ? atan2(gWorld->player.physics.y - drones->y[i], gWorld->player.physics.x - drones->x[i]) : atan2(drones->vy[i], drones->vx[i]);
+		if (drones->fighter[i])
+			vk2dColourHex(colour, "#20326e");
+		instanceDraw(sprite, x - originX, y - originY, 1, 1, heading, originX, originY, colour);
+	} else {
+		float scale = (float)drones->dyingTimer[i] / (float)DRONE_DYING_TIMER;
+		instanceDraw(sprite, x - originX, y - originY, scale, scale, drones->dyingRotation[i], originX, originY, colour);
 	}
+	return true;
 }
 
-void garbageDisposalEnd(Entity *entity) {
-	vk2dRendererWait();
+/********************* Garbage disposal functions *********************/
+// Renders the 3D model at some rotation into texture
+void garbageDisposalRender(VK2DTexture texture, float rotation) {
+	vk2dRendererSetTarget(texture);
+	vk2dRendererEmpty();
+	vk2dRendererLockCameras(g3DCam);
+	vec3 axis = {0, 1, 0};
+	vk2dRendererDrawModel(gGarbageModel, 0, 0, 0, 1, 1, 1, rotation, axis, 0, 0, 0);
+	vk2dRendererLockCameras(gCam);
+	vk2dRendererSetTarget(VK2D_TARGET_SCREEN);
 }
 
-/********************* Population functions *********************/
-void popInit() {
-	gPopulation.entities = NULL;
-	gPopulation.size = 0;
-}
-
-// Returns a pointer to an entity you can fill out that will be in the population
-Entity* popGetNewEntity(int *location) {
-	int found = -1;
-	for (int i = 0; i < gPopulation.size; i++)
-		if (gPopulation.entities[i].type == ENTITY_TYPE_NONE)
-			found = i;
-
-	if (found == -1) {
-		gPopulation.entities = realloc(gPopulation.entities, (gPopulation.size + 5) * sizeof(Entity));
-		for (int i = gPopulation.size; i < gPopulation.size + 5; i++)
-			gPopulation.entities[i].type = ENTITY_TYPE_NONE;
-		found = gPopulation.size;
-		gPopulation.size += 5;
+// Picks the texture the disposals are drawn with this frame, the baked frame nearest the current rotation unless it's being rendered live
+void garbageDisposalUpdate() {
+	float rotation = sin(juTime() * 0.5) * GARBAGE_DISPOSAL_SWING;
+	if (gGarbageDisposalLive) {
+		garbageDisposalRender(gGarbageDisposalTexture, rotation);
+		gGarbageDisposalCurrent = gGarbageDisposalTexture;
+		return;
 	}
 
-	if (location != NULL)
-		*location = found;
-	return &gPopulation.entities[found];
-}
-
-void popUpdateEntities() {
-	for (int i = 0; i < gPopulation.size; i++) {
-		if (gPopulation.entities[i].type == ENTITY_TYPE_TRASH) {
-			trashUpdate(&gPopulation.entities[i]);
-		} else if (gPopulation.entities[i].type == ENTITY_TYPE_DRONE) {
-			droneUpdate(&gPopulation.entities[i]);
-		} else if (gPopulation.entities[i].type == ENTITY_TYPE_MINE) {
-			mineUpdate(&gPopulation.entities[i]);
-		} else if (gPopulation.entities[i].type == ENTITY_TYPE_GARBAGE_DISPOSAL) {
-			garbageDisposalUpdate(&gPopulation.entities[i]);
-		}
+	int frame = (int)round(((rotation / GARBAGE_DISPOSAL_SWING) + 1) * 0.5 * (GARBAGE_DISPOSAL_FRAMES - 1));
+	frame = juClamp(frame, 0, GARBAGE_DISPOSAL_FRAMES - 1);
+	if (!gGarbageDisposalBaked[frame]) {
+		float frameRotation = (((float)frame / (GARBAGE_DISPOSAL_FRAMES - 1)) * 2 - 1) * GARBAGE_DISPOSAL_SWING;
+		garbageDisposalRender(gGarbageDisposalFrames[frame], frameRotation);
+		gGarbageDisposalBaked[frame] = true;
 	}
+	gGarbageDisposalCurrent = gGarbageDisposalFrames[frame];
 }
 
-void popEnd() {
-	free(gPopulation.entities);
-}
+void garbageDisposalDraw(int i) {
+	DisposalPool *disposals = &gWorld->population.disposals;
+	float scale = 6;
+	vk2dDrawTextureExt(gGarbageDisposalCurrent, disposals->x[i] - ((GARBAGE_DISPOSAL_WIDTH * scale) / 2), disposals->y[i] - ((GARBAGE_DISPOSAL_HEIGHT * scale) / 2), scale, scale, 0, 0, 0);
 
-Entity* popGet(int location) {
-	return &gPopulation.entities[location];
+	if (DEBUG) {
+		vk2dDrawCircle(disposals->x[i], disposals->y[i], 4);
+		vk2dDrawCircleOutline(disposals->x[i], disposals->y[i], disposals->gravityRadius[i], 1);
+		vk2dDrawCircleOutline(disposals->x[i], disposals->y[i], disposals->grabRadius[i], 1);
+	}
 }
 
-/********************* Player functions *********************/
-void playerStart() {
-	memset(&gPlayer, 0, sizeof(Entity));
-	gPlayer.type = ENTITY_TYPE_PLAYER;
-	physicsStart(&gPlayer.physics, PLAYER_START_X, PLAYER_START_Y);
-	gPlayer.player.grabbedTrash = NO_TRASH;
-	gPlayer.player.hp = PLAYER_BASE_HP;
-}
-
-void playerUpdate() {
-	if (gPlayer.player.hp > 0) {
-		// Rotate the ship
-		if (juKeyboardGetKey(SDL_SCANCODE_A) || juKeyboardGetKey(SDL_SCANCODE_D)) {
-			gPlayer.player.dirVelocity +=
-					(-((real) juKeyboardGetKey(SDL_SCANCODE_A)) + ((real) juKeyboardGetKey(SDL_SCANCODE_D))) *
-					PLAYER_BASE_ROTATE_ACCELERATION;
-		} else {
-			if (juSign(gPlayer.player.dirVelocity - juSign(gPlayer.player.dirVelocity) * PLAYER_BASE_ROTATE_FRICTION) !=
-				juSign(gPlayer.player.dirVelocity))
-				gPlayer.player.dirVelocity = 0;
-			else
-				gPlayer.player.dirVelocity -= juSign(gPlayer.player.dirVelocity) * PLAYER_BASE_ROTATE_FRICTION;
-		}
-		gPlayer.player.dirVelocity = juClamp(gPlayer.player.dirVelocity, -PLAYER_BASE_ROTATE_TOP_SPEED,
-											 PLAYER_BASE_ROTATE_TOP_SPEED);
-		gPlayer.player.direction += gPlayer.player.dirVelocity;
-
-		// Calculate acceleration vector
-		Vector acceleration = {};
-		if (juKeyboardGetKey(SDL_SCANCODE_W)) {
-			acceleration.magnitude = PLAYER_BASE_ACCELERATION;
-			acceleration.direction = gPlayer.player.direction;
-		} else {
-			acceleration.magnitude = PLAYER_FRICTION;
-			acceleration.direction = gPlayer.physics.velocity.direction + VK2D_PI;
-		}
+/********************* Population functions *********************/
+void popDrawEntities() {
+	for (int i = 0; i < gWorld->population.disposals.count; i++)
+		garbageDisposalDraw(i);
+
+	// Every sprite is in the atlas so this is one instanced draw for everything, loose files cost a draw each
+	// time the texture changes. Anything off screen is skipped.
+	gCullView = vk2dCameraGetSpec(gCam);
+	int visible = 0;
+	instanceBeginFrame(gWorld->population.trash.count + gWorld->population.drones.count);
+	for (int i = 0; i < gWorld->population.trash.count; i++)
+		visible += trashDraw(i);
+	for (int i = 0; i < gWorld->population.drones.count; i++)
+		visible += droneDraw(i);
+	instanceFlush();
+	PROFILE_COUNT(PROFILE_COUNTER_VISIBLE, visible);
+	PROFILE_COUNT(PROFILE_COUNTER_CULLED, gWorld->population.trash.count + gWorld->population.drones.count - visible);
 
-		// Check if the player grabs some trash
-		if (juKeyboardGetKeyPressed(SDL_SCANCODE_SPACE)) {
-			for (int i = 0; i < gPopulation.size && gPlayer.player.grabbedTrash == NO_TRASH; i++) {
-				if (gPopulation.entities[i].type == ENTITY_TYPE_TRASH &&
-					juPointDistance(gPlayer.physics.x, gPlayer.physics.y, gPopulation.entities[i].physics.x,
-									gPopulation.entities[i].physics.y) < PLAYER_BASE_TRASH_GRAB_DISTANCE) {
-					gPlayer.player.grabbedTrash = i;
-					gPopulation.entities[i].trash.grabbed = true;
-				}
+	if (DEBUG) {
+		for (int i = 0; i < gWorld->population.trash.count; i++)
+			vk2dDrawCircle(gWorld->population.trash.x[i], gWorld->population.trash.y[i], 4);
+		for (int i = 0; i < gWorld->population.drones.count; i++) {
+			if (!gWorld->population.drones.dying[i]) {
+				vk2dDrawCircleOutline(gWorld->population.drones.x[i], gWorld->population.drones.y[i], DRONE_DAMAGE_RADIUS, 1);
+				vk2dDrawCircle(gWorld->population.drones.x[i], gWorld->population.drones.y[i], 4);
 			}
-		} else if (juKeyboardGetKeyReleased(SDL_SCANCODE_SPACE) && gPlayer.player.grabbedTrash != NO_TRASH) {
-			Entity *trash = &gPopulation.entities[gPlayer.player.grabbedTrash];
-			trash->physics.velocity.direction = gPlayer.player.direction;
-			trash->physics.velocity.magnitude = PLAYER_BASE_TRASH_THROW_SPEED;
-			trash->trash.wasThrown = true;
-			trash->trash.grabbed = false;
-			gPlayer.player.grabbedTrash = NO_TRASH;
 		}
-
-		// Do stuff with grabbed trash
-		if (gPlayer.player.grabbedTrash != NO_TRASH) {
-			Entity *trash = &gPopulation.entities[gPlayer.player.grabbedTrash];
-			trash->physics.x = gPlayer.physics.x + juCastX(PLAYER_TRASH_DRAW_DISTANCE, -gPlayer.player.direction);
-			trash->physics.y = gPlayer.physics.y + juCastY(PLAYER_TRASH_DRAW_DISTANCE, -gPlayer.player.direction);
-		}
-
-		// IFrames
-		if (gPlayer.player.iframes > 0)
-			gPlayer.player.iframes -= 1;
-
-		physicsUpdate(&gPlayer.physics, &acceleration);
-	} else {
-		// Dying animation
-		gPlayer.player.direction += PLAYER_DYING_ROTATE_SPEED;
-		physicsUpdate(&gPlayer.physics, NULL);
 	}
 }
 
+/********************* Player functions *********************/
+// Builds this frame's player controls from the keyboard
+PlayerInput playerReadInput() {
+	PlayerInput input = {};
+	input.left = juKeyboardGetKey(SDL_SCANCODE_A);
+	input.right = juKeyboardGetKey(SDL_SCANCODE_D);
+	input.thrust = juKeyboardGetKey(SDL_SCANCODE_W);
+	input.grabPressed = juKeyboardGetKeyPressed(SDL_SCANCODE_SPACE);
+	input.grabReleased = juKeyboardGetKeyReleased(SDL_SCANCODE_SPACE);
+	return input;
+}
+
 void playerDraw() {
-	VK2DTexture player;
-	if (juKeyboardGetKey(SDL_SCANCODE_W))
-		player = gAssets->texPlayerThruster;
+	const Sprite *player;
+	if (gInput.thrust)
+		player = &gSprites[SPRITE_PLAYER_THRUSTER];
 	else
-		player = gAssets->texPlayer;
+		player = &gSprites[SPRITE_PLAYER];
 
 	// Account for iframe blinking
-	if (gPlayer.player.iframes <= 0 || (gPlayer.player.iframes / PLAYER_DAMAGED_BLINKING_INTERVAL) % 2 == 0) {
-		vk2dDrawTextureExt(player, gPlayer.physics.x - (vk2dTextureWidth(player) / 2),
-						   gPlayer.physics.y - (vk2dTextureHeight(player) / 2), 1, 1,
-						   gPlayer.player.direction + (VK2D_PI / 2), vk2dTextureWidth(player) / 2,
-						   vk2dTextureHeight(player) / 2);
+	if (gWorld->player.player.iframes <= 0 || (gWorld->player.player.iframes / PLAYER_DAMAGED_BLINKING_INTERVAL) % 2 == 0) {
+		drawSprite(player, blend(gWorld->player.physics.lastX, gWorld->player.physics.x) - (player->w / 2),
+				   blend(gWorld->player.physics.lastY, gWorld->player.physics.y) - (player->h / 2), 1, 1,
+				   gWorld->player.player.direction + (VK2D_PI / 2), player->w / 2, player->h / 2);
 	}
 
 	if (DEBUG) {
-		vk2dDrawCircleOutline(gPlayer.physics.x, gPlayer.physics.y, PLAYER_BASE_TRASH_GRAB_DISTANCE, 1);
-		vk2dDrawCircle(gPlayer.physics.x, gPlayer.physics.y, 4);
-	}
-}
-
-void playerEnd() {
-
-}
-
-bool recordHighscore();
-void playerTakeDamage(Entity *entity) {
-	if (gPlayer.player.hp > 0 && gPlayer.player.iframes <= 0) {
-		gPlayer.player.hp -= 1;
-		gPlayer.player.iframes = PLAYER_DAMAGED_IFRAMES;
-		gPlayer.physics.velocity = entity->physics.velocity;
-
-		// Player just died
-		if (gPlayer.player.hp <= 0) {
-			gNewHighscore = recordHighscore();
-			gGameoverDelay = 0;
-		}
+		vk2dDrawCircleOutline(gWorld->player.physics.x, gWorld->player.physics.y, PLAYER_BASE_TRASH_GRAB_DISTANCE, 1);
+		vk2dDrawCircle(gWorld->player.physics.x, gWorld->player.physics.y, 4);
 	}
 }
 
 /********************* Game functions *********************/
 
-// Returns true if a new highscore was recorded
-bool recordHighscore() {
-	if (gScore > gHighscore) {
-		FILE *f = fopen(HIGHSCORE_FILE, "wb");
-		gHighscore = gScore;
-		fwrite(&gHighscore, sizeof(real), 1, f);
-		fclose(f);
+// Hands the run that just ended to the stats writer, returns true if it's a new highscore
+bool recordRun() {
+	StatsRun run = {time(NULL), gWorld->score, gWorld->ticks, gWorld->kills, gWorld->trashDisposed, 0};
+	if (!statsSubmit(&run))
+		printf("Couldn't queue the run to be saved\n");
+	if (gWorld->score > gHighscore) {
+		gHighscore = gWorld->score;
 		return true;
 	} else {
 		return false;
 	}
 }
 
-void readHighscore() {
-	FILE *f = fopen(HIGHSCORE_FILE, "rb");
-	if (f != NULL) {
-		fread(&gHighscore, sizeof(real), 1, f);
-		fclose(f);
-	} else {
-		gHighscore = 0;
-	}
-}
-
 void gameDrawUI() {
 	// Get screen w/h
 	VK2DCameraSpec spec = vk2dCameraGetSpec(VK2D_DEFAULT_CAMERA);
 	VK2DCameraSpec gameWorldCameraSpec = vk2dCameraGetSpec(gCam);
-	Entity *gd = popGet(gGarbageDisposal);
-
-	// Point to garbage disposal
-	if (juPointDistance(gPlayer.physics.x, gPlayer.physics.y, gd->physics.x, gd->physics.y) > gameWorldCameraSpec.h / 2) {
-		float angle = juPointAngle(gPlayer.physics.x, gPlayer.physics.y, gd->physics.x, gd->physics.y);
-		float originX = vk2dTextureWidth(gAssets->texArrow) / 2;
-		float originY = vk2dTextureHeight(gAssets->texArrow) / 2;
+	int gd;
+	real gdDistance;
+	int found = spatialQueryNearest(&gWorld->spatial, gWorld->player.physics.x, gWorld->player.physics.y, WORLD_MAX_WIDTH + WORLD_MAX_HEIGHT,
+									SPATIAL_MASK(ENTITY_TYPE_GARBAGE_DISPOSAL), NULL, NULL, 1, &gd, &gdDistance);
+
+	// Point to the closest garbage disposal
+	if (found == 1 && gdDistance > gameWorldCameraSpec.h / 2) {
+		float angle = juPointAngle(gWorld->player.physics.x, gWorld->player.physics.y, gWorld->population.disposals.x[gd], gWorld->population.disposals.y[gd]);
+		const Sprite *arrow = &gSprites[SPRITE_ARROW];
+		float originX = arrow->w / 2;
+		float originY = arrow->h / 2;
 		float x = (spec.x + (spec.w / 2)) + juCastX((spec.w / 2) - originX, angle);
 		float y = (spec.y + (spec.h / 2)) + juCastY((spec.h / 2) - originY, angle);
-		vk2dDrawTextureExt(gAssets->texArrow, x - originX, y - originY, 1, 1, -angle + (VK2D_PI / 2), originX, originY);
+		drawSprite(arrow, x - originX, y - originY, 1, 1, -angle + (VK2D_PI / 2), originX, originY);
 	}
 
 	// Player life
-	for (int i = 0; i < gPlayer.player.hp; i++) {
-		vk2dDrawTexture(gAssets->texHP, 10 + (i * vk2dTextureWidth(gAssets->texHP)), 10);
+	for (int i = 0; i < gWorld->player.player.hp; i++) {
+		drawSprite(&gSprites[SPRITE_HP], 10 + (i * gSprites[SPRITE_HP].w), 10, 1, 1, 0, 0, 0);
 	}
 
 	// Score
-	char score[100];
-	snprintf(score, 100, "$%.2f", gScore);
-	juFontDraw(gFont, spec.w - 10 - (strlen(score) * gFont->characters[0].w), 10, score);
+	textRunSetValue(&gTextScore, "$%.2f", gWorld->score);
+	textRunDraw(&gTextScore, spec.w - 10 - gTextScore.width, 10);
 
 	// Player velocity
 	vec4 outline = {0, 0.2, 0, 1};
@@ -692,8 +586,8 @@ void gameDrawUI() {
 	float h = 80;
 	float centerX = topLeftX + (w / 2);
 	float centerY = topLeftY + (h / 2);
-	float rise = (sin(gPlayer.physics.velocity.direction) * gPlayer.physics.velocity.magnitude) * 2.5;
-	float run = (cos(gPlayer.physics.velocity.direction) * gPlayer.physics.velocity.magnitude) * 3.5;
+	float rise = gWorld->player.physics.velocity.y * 2.5;
+	float run = gWorld->player.physics.velocity.x * 3.5;
 	vk2dRendererSetColourMod(fill);
 	vk2dDrawRectangle(topLeftX, topLeftY, w, h); // Background
 	vk2dRendererSetColourMod(outline);
@@ -714,57 +608,99 @@ void gameDrawUI() {
 		vk2dRendererSetColourMod(blackOverlay);
 		vk2dRendererClear();
 		vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
-		const char *s = "You're fired.";
-		juFontDraw(gFont, (spec.w / 2) - ((strlen(s) * gFont->characters[0].w) / 2), (spec.h / 2) - 30, s);
-
-		if (gScore == gHighscore) {
-			s = "New highscore!";
-			juFontDraw(gFont, (spec.w / 2) - ((strlen(s) * gFont->characters[0].w) / 2), (spec.h / 2) + 30, s);
-		}
-	} else if (gPlayer.player.hp <= 0) {
-		gGameoverDelay += 1;
+		textRunDraw(&gTextFired, (spec.w / 2) - (gTextFired.width / 2), (spec.h / 2) - 30);
+		if (gWorld->score == gHighscore)
+			textRunDraw(&gTextNewHighscore, (spec.w / 2) - (gTextNewHighscore.width / 2), (spec.h / 2) + 30);
 	}
 }
 
 void gameStart() {
-	srand(time(NULL));
-	popInit();
-	playerStart();
-	garbageDisposalStart(popGetNewEntity(&gGarbageDisposal));
-	gSpawnDelay = 0;
-	gLastGarbageTime = juTime();
+	VK2DCameraSpec spec = vk2dCameraGetSpec(gCam);
+	SimView view = {spec.x, spec.y, spec.w, spec.h};
+	uint64_t seed = time(NULL);
+	if (gReplayFile != NULL) {
+		replayRewind(&gReplay);
+		seed = gReplay.seed;
+		view = gReplay.view;
+		gWorld->lod = gReplay.lod;
+		gReplayDiverged = false;
+	} else if (gRecordFile != NULL) {
+		replayStartRecording(&gReplay, seed, view);
+	}
+	simStart(seed, view);
+#ifdef LECD_DEBUG_REWIND
+	snapshotClear(&gRewind);
+	snapshotCapture(&gRewind);
+#endif
 	gNewHighscore = false;
+	gTickAccumulator = 0;
+	gInput = (PlayerInput){};
 }
 
 gamestate gameUpdate() {
-	real time = juTime();
-	if (time - gLastGarbageTime >= TRASH_SPAWN_INTERVAL) {
-		gLastGarbageTime = time;
-		trashStart(popGetNewEntity(NULL));
+	// Held keys are whatever they are now, presses are kept until a tick gets to see them
+	VK2DCameraSpec spec = vk2dCameraGetSpec(gCam);
+	if (gReplayFile == NULL) {
+		PlayerInput input = playerReadInput();
+		gInput.left = input.left;
+		gInput.right = input.right;
+		gInput.thrust = input.thrust;
+		gInput.grabPressed = gInput.grabPressed || input.grabPressed;
+		gInput.grabReleased = gInput.grabReleased || input.grabReleased;
 	}
+	gWorld->view.w = spec.w;
+	gWorld->view.h = spec.h;
+
+	// Step the simulation in fixed ticks for however much time has passed
+	PROFILE_BEGIN(PROFILE_ZONE_SIM);
+	gTickAccumulator = fmin(gTickAccumulator + juDelta(), MAX_FRAME_TICKS / FPS_LIMIT);
+	while (gTickAccumulator >= 1 / FPS_LIMIT) {
+		// Recordings also bring their own view size, after they run out the world just sits there
+		if (gReplayFile != NULL && !replayNext(&gReplay, &gInput)) {
+			gTickAccumulator = 0;
+			break;
+		}
 
-	// Enemy spawning
-	if (gSpawnDelay >= DRONE_SPAWN_DELAY) {
-		if (time - gLastEnemyTime >= DRONE_SPAWN_INTERVAL) {
-			gLastEnemyTime = time;
-			if (gEnemyCount < gEnemyMax) {
-				droneStart(popGetNewEntity(NULL));
-			} else if (time - gEnemyCountLastTime >= DRONE_MAX_INTERVAL) {
-				gEnemyCountLastTime = time;
-				gEnemyMax++;
-			}
+#ifdef LECD_DEBUG_REWIND
+		// Holding R steps back through the last few seconds instead, recordings have to play out exactly so they can't
+		if (gReplayFile == NULL && gRecordFile == NULL && gWorld->player.player.hp > 0 && juKeyboardGetKey(SDL_SCANCODE_R)) {
+			long tick = snapshotNewest(&gRewind) - 1;
+			if (tick >= snapshotOldest(&gRewind))
+				snapshotRestore(&gRewind, tick);
+			gTickAccumulator -= 1 / FPS_LIMIT;
+			continue;
+		}
+#endif
+
+		bool wasAlive = gWorld->player.player.hp > 0;
+		simUpdate(&gInput);
+#ifdef LECD_DEBUG_REWIND
+		snapshotCapture(&gRewind);
+#endif
+		if (gRecordFile != NULL) {
+			replayRecord(&gReplay, &gInput);
+		} else if (gReplayFile != NULL && !replayVerify(&gReplay) && !gReplayDiverged) {
+			printf("Replay diverged from the recording at tick %ld\n", gReplay.tick);
+			gReplayDiverged = true;
+		}
+		gInput.grabPressed = false;
+		gInput.grabReleased = false;
+		gTickAccumulator -= 1 / FPS_LIMIT;
+
+		// Player just died
+		if (wasAlive && gWorld->player.player.hp <= 0) {
+			gNewHighscore = recordRun();
+			gGameoverDelay = 0;
+		} else if (gWorld->player.player.hp <= 0 && gGameoverDelay < GAME_OVER_DELAY) {
+			gGameoverDelay += 1;
 		}
-	} else {
-		gSpawnDelay++;
-		gLastEnemyTime = juTime();
 	}
+	gBlend = gTickAccumulator * FPS_LIMIT;
+	PROFILE_END(PROFILE_ZONE_SIM);
 
 	// Update camera around player
-	VK2DCameraSpec spec = vk2dCameraGetSpec(gCam);
-	spec.x += ((gPlayer.physics.x - (spec.w / 2)) - spec.x) * CAMERA_SPEED;
-	spec.y += ((gPlayer.physics.y - (spec.h / 2)) - spec.y) * CAMERA_SPEED;
-	spec.x = juClamp(spec.x, 0, WORLD_MAX_WIDTH - spec.w);
-	spec.y = juClamp(spec.y, 0, WORLD_MAX_HEIGHT - spec.h);
+	spec.x = blend(gWorld->lastView.x, gWorld->view.x);
+	spec.y = blend(gWorld->lastView.y, gWorld->view.y);
 	vk2dCameraUpdate(gCam, spec);
 
 	// Lock camera to world camera and draw world
@@ -772,47 +708,55 @@ gamestate gameUpdate() {
 	float cx = spec.x + (spec.w / 2);
 	float cy = spec.y + (spec.h / 2);
 	vk2dDrawTexture(gAssets->texSun, cx + SUN_POS_X, cy + SUN_POS_Y);
+	PROFILE_BEGIN(PROFILE_ZONE_BACKGROUND);
 	drawTiledBackground(gAssets->texBackground, 0.8);
 	drawTiledBackground(gAssets->texMidground, 0.6);
 	drawTiledBackground(gAssets->texForeground, 0.5);
+	PROFILE_END(PROFILE_ZONE_BACKGROUND);
 
-	// Update entities
-	playerUpdate();
-	popUpdateEntities();
+	// Draw entities
+	PROFILE_BEGIN(PROFILE_ZONE_DRAW_ENTITIES);
+	popDrawEntities();
 	playerDraw();
+	PROFILE_END(PROFILE_ZONE_DRAW_ENTITIES);
 
 	// UI is drawn to the default camera
 	vk2dRendererLockCameras(VK2D_DEFAULT_CAMERA);
+	PROFILE_BEGIN(PROFILE_ZONE_UI);
 	gameDrawUI();
+	PROFILE_END(PROFILE_ZONE_UI);
 
 	vk2dRendererUnlockCameras();
 
-	if (juKeyboardGetKeyPressed(SDL_SCANCODE_SPACE) && gPlayer.player.hp <= 0 && gGameoverDelay >= GAME_OVER_DELAY)
+	bool replayOver = gReplayFile != NULL && gReplay.tick >= gReplay.ticks;
+	if (juKeyboardGetKeyPressed(SDL_SCANCODE_SPACE) && ((gWorld->player.player.hp <= 0 && gGameoverDelay >= GAME_OVER_DELAY) || replayOver))
 		return GAMESTATE_MENU;
 	return GAMESTATE_GAME;
 }
 
 void gameEnd() {
-	popEnd();
-	gGarbageDisposal = 0;
-	playerEnd();
+	if (gRecordFile != NULL && !replaySave(&gReplay, gRecordFile))
+		printf("Failed to save recording to \"%s\"\n", gRecordFile);
+	simEnd();
 }
 
 /********************* Menu functions *********************/
 void menuStart() {
-	readHighscore();
+
 }
 
 gamestate menuUpdate() {
 	// Space background
 	VK2DCameraSpec spec = vk2dCameraGetSpec(gCam);
-	spec.x += 1;
-	spec.y += 0.5;
+	spec.x += FPS_LIMIT * juDelta();
+	spec.y += (FPS_LIMIT / 2) * juDelta();
 	vk2dCameraUpdate(gCam, spec);
 	vk2dRendererLockCameras(gCam);
+	PROFILE_BEGIN(PROFILE_ZONE_BACKGROUND);
 	drawTiledBackground(gAssets->texBackground, 0.8);
 	drawTiledBackground(gAssets->texMidground, 0.6);
 	drawTiledBackground(gAssets->texForeground, 0.5);
+	PROFILE_END(PROFILE_ZONE_BACKGROUND);
 
 	// 2nd layer background
 	vk2dRendererLockCameras(VK2D_DEFAULT_CAMERA);
@@ -822,19 +766,17 @@ gamestate menuUpdate() {
 	vk2dRendererClear();
 	vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
 	float scale = 4;
-	vk2dDrawTextureExt(gGarbageDisposalTexture, (spec.w / 2) - ((GARBAGE_DISPOSAL_WIDTH * scale) / 2), (spec.h / 2) - ((GARBAGE_DISPOSAL_HEIGHT * scale) / 2) + (spec.h  * 0.1), scale, scale, 0, 0, 0);
+	vk2dDrawTextureExt(gGarbageDisposalCurrent, (spec.w / 2) - ((GARBAGE_DISPOSAL_WIDTH * scale) / 2), (spec.h / 2) - ((GARBAGE_DISPOSAL_HEIGHT * scale) / 2) + (spec.h  * 0.1), scale, scale, 0, 0, 0);
 	float bgscale = spec.h / vk2dTextureHeight(gAssets->textitle);
 	float drawX = (spec.w - (vk2dTextureWidth(gAssets->textitle) * bgscale)) / 2;
 	vk2dDrawTextureExt(gAssets->textitle, drawX, 0, bgscale, bgscale, 0, 0, 0);
 
-	// Text
-	const char *s = "Press space to play";
-	juFontDraw(gFont, (spec.w / 2) - ((strlen(s) * gFont->characters[0].w) / 2), (spec.h / 2) - 30, s);
-
+	// Text, the saved highscore is loaded in the background so it may show up a few frames in
+	gHighscore = fmax(gHighscore, statsHighscore());
+	textRunDraw(&gTextPrompt, (spec.w / 2) - (gTextPrompt.width / 2), (spec.h / 2) - 30);
 	if (gHighscore != 0) {
-		char score[100];
-		snprintf(score, 99, "Highscore: $%0.2f", gHighscore);
-		juFontDraw(gFont, drawX + 2, 2, score);
+		textRunSetValue(&gTextHighscore, "Highscore: $%0.2f", gHighscore);
+		textRunDraw(&gTextHighscore, drawX + 2, 2);
 	}
 
 	if (juKeyboardGetKeyPressed(SDL_SCANCODE_SPACE))
@@ -849,13 +791,66 @@ void menuEnd() {
 
 }
 
+/********************* Profiler functions *********************/
+// Frame time breakdown in the top right corner, averageFrame is in seconds
+void profileDrawOverlay(double averageFrame) {
+	// Drawn through its own camera so the text can be smaller than the font
+	VK2DCameraSpec spec = vk2dCameraGetSpec(VK2D_DEFAULT_CAMERA);
+	spec.x = spec.y = 0;
+	spec.w = spec.wOnScreen * PROFILE_OVERLAY_SCALE;
+	spec.h = spec.hOnScreen * PROFILE_OVERLAY_SCALE;
+	vk2dCameraUpdate(gOverlayCam, spec);
+	vk2dRendererLockCameras(gOverlayCam);
+
+	float lineHeight = FONT_HEIGHT;
+	float w = FONT_WIDTH * 24;
+	float x = spec.w - w - 20;
+	float y = 300;
+	float barScale = (w / 2) / (1000 / FPS_LIMIT); // A full tick's worth of milliseconds is half the width
+	vec4 background = {0, 0, 0, 0.6};
+	vec4 bar = {0.9, 0.5, 0.1, 0.8};
+	vk2dRendererSetColourMod(background);
+	vk2dDrawRectangle(x - 10, y - 10, w + 20, (PROFILE_ZONE_MAX + PROFILE_COUNTER_MAX + 1) * lineHeight + 20);
+	vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
+	juFontDraw(gFont, x, y, "%.0ffps %.2fms%s", averageFrame > 0 ? 1 / averageFrame : 0, averageFrame * 1000, profileTraceRunning() ? " rec" : "");
+	for (int i = 0; i < PROFILE_ZONE_MAX; i++) {
+		float lineY = y + ((i + 1) * lineHeight);
+		double ms = profileZoneAverage(i);
+		vk2dRendererSetColourMod(bar);
+		vk2dDrawRectangle(x + (w / 2), lineY + (lineHeight / 4), fmin(ms * barScale, w / 2), lineHeight / 2);
+		vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
+		juFontDraw(gFont, x, lineY, "%-15s%.2f", profileZoneName(i), ms);
+	}
+	for (int i = 0; i < PROFILE_COUNTER_MAX; i++)
+		juFontDraw(gFont, x, y + ((PROFILE_ZONE_MAX + i + 1) * lineHeight), "%-15s%.0f", profileCounterName(i), profileCounterAverage(i));
+	vk2dRendererUnlockCameras();
+}
+
 /********************* Main *********************/
-int main() {
+// -r <file> records every game to file, -p <file> plays a recording back each time a game is started
+int main(int argc, char **argv) {
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "-r") == 0) {
+			gRecordFile = argv[++i];
+		} else if (strcmp(argv[i], "-p") == 0) {
+			gReplayFile = argv[++i];
+			if (!replayLoad(&gReplay, gReplayFile)) {
+				printf("Failed to load recording \"%s\"\n", gReplayFile);
+				return 1;
+			}
+		}
+	}
+
 	// Initialize a billion things
 	SDL_Window *window = SDL_CreateWindow("LECD", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 	SDL_Event e;
 	VK2DRendererConfig config = {VK2D_MSAA_1X, VK2D_SCREEN_MODE_TRIPLE_BUFFER, VK2D_FILTER_TYPE_NEAREST};
 	juInit(window, 3, 1);
+	jobsInit(0);
+	statsInit(HIGHSCORE_FILE, STATS_FILE);
+#ifdef LECD_DEBUG_REWIND
+	snapshotInit(&gRewind, REWIND_TICKS);
+#endif
 	vk2dRendererInit(window, config, NULL);
 	vec4 clearColour = {0, 0, 13.0/255.0, 1}; // Black
 	vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
@@ -872,12 +867,25 @@ int main() {
 	spec3D.Perspective.up[1] = 1;
 	gCam = vk2dCameraCreate(spec);
 	g3DCam = vk2dCameraCreate(spec3D);
-	gAssets = buildAssets();
-	gFont = juFontLoadFromImage("assets/Font.png", 32, 128, FONT_WIDTH, FONT_HEIGHT);
+	gOverlayCam = vk2dCameraCreate(spec);
+	gAssets = packBuildAssets();
+	if (gAssets != NULL) {
+		gGarbageModel = packBuildModel("assets/GarbageDisposal.obj", gAssets->texGarbageDisposal);
+		gShader = packBuildShader("assets/tex.vert.spv", "assets/tex.frag.spv", 4);
+	} else {
+		gAssets = buildAssets();
+		spritesFromAssets(gAssets);
+		gGarbageModel = vk2dModelLoad("assets/GarbageDisposal.obj", gAssets->texGarbageDisposal);
+		gShader = vk2dShaderLoad("assets/tex.vert.spv", "assets/tex.frag.spv", 4);
+	}
+	gFont = juFontLoadFromImage("assets/Font.png", FONT_FIRST_CHARACTER, FONT_LAST_CHARACTER, FONT_WIDTH, FONT_HEIGHT);
+	textRunSet(&gTextPrompt, "Press space to play");
+	textRunSet(&gTextFired, "You're fired.");
+	textRunSet(&gTextNewHighscore, "New highscore!");
 	gamestate state = GAMESTATE_MENU;
-	gGarbageModel = vk2dModelLoad("assets/GarbageDisposal.obj", gAssets->texGarbageDisposal);
-	gShader = vk2dShaderLoad("assets/tex.vert.spv", "assets/tex.frag.spv", 4);
 	gGarbageDisposalTexture = vk2dTextureCreate(GARBAGE_DISPOSAL_WIDTH, GARBAGE_DISPOSAL_HEIGHT);
+	for (int i = 0; i < GARBAGE_DISPOSAL_FRAMES; i++)
+		gGarbageDisposalFrames[i] = vk2dTextureCreate(GARBAGE_DISPOSAL_WIDTH, GARBAGE_DISPOSAL_HEIGHT);
 	menuStart();
 	JUClock fpsLock;
 	gZoom = ZOOM_MAX;
@@ -885,6 +893,8 @@ int main() {
 
 	// Game loop, just calls either menu or game update and swaps between them when necessary
 	while (!stopRunning) {
+		PROFILE_BEGIN(PROFILE_ZONE_FRAME);
+		PROFILE_BEGIN(PROFILE_ZONE_INPUT);
 		juUpdate();
 		while (SDL_PollEvent(&e)) {
 			if (e.type == SDL_QUIT) {
@@ -892,6 +902,23 @@ int main() {
 				abort();
 			}
 		}
+		PROFILE_END(PROFILE_ZONE_INPUT);
+
+#ifdef LECD_PROFILE
+		// F3 toggles the profiler overlay, F4 starts a trace capture then saves it the next time it's pressed
+		if (juKeyboardGetKeyPressed(SDL_SCANCODE_F3))
+			gProfileOverlay = !gProfileOverlay;
+		if (juKeyboardGetKeyPressed(SDL_SCANCODE_F4)) {
+			if (!profileTraceRunning())
+				profileTraceStart();
+			else if (!profileTraceSave(TRACE_FILE))
+				printf("Failed to save trace to \"%s\"\n", TRACE_FILE);
+		}
+#endif
+
+		// F5 swaps between the baked disposal frames and rendering the model live
+		if (juKeyboardGetKeyPressed(SDL_SCANCODE_F5))
+			gGarbageDisposalLive = !gGarbageDisposalLive;
 
 		// Handle zoom
 		gZoom += (((real) juKeyboardGetKeyPressed(SDL_SCANCODE_Q)) - ((real) juKeyboardGetKeyPressed(SDL_SCANCODE_E))) * ZOOM_SPEED;
@@ -915,13 +942,9 @@ int main() {
 
 		vk2dRendererStartFrame(clearColour);
 
-		vk2dRendererSetTarget(gGarbageDisposalTexture);
-		vk2dRendererEmpty();
-		vk2dRendererLockCameras(g3DCam);
-		vec3 axis = {0, 1, 0};
-		vk2dRendererDrawModel(gGarbageModel, 0, 0, 0, 1, 1, 1, sin(juTime() * 0.5) * 0.5, axis, 0, 0, 0);
-		vk2dRendererLockCameras(gCam);
-		vk2dRendererSetTarget(VK2D_TARGET_SCREEN);
+		PROFILE_BEGIN(PROFILE_ZONE_DISPOSAL_RENDER);
+		garbageDisposalUpdate();
+		PROFILE_END(PROFILE_ZONE_DISPOSAL_RENDER);
 
 		if (state == GAMESTATE_MENU) {
 			state = menuUpdate();
@@ -955,8 +978,16 @@ int main() {
 			totalTime += juDelta();
 			iters += 1;
 		}
-		juClockFramerate(&fpsLock, FPS_LIMIT); // Lock framerate
+		if (gProfileOverlay)
+			profileDrawOverlay(average);
+		PROFILE_BEGIN(PROFILE_ZONE_WAIT);
+		juClockFramerate(&fpsLock, RENDER_FPS_LIMIT); // Lock framerate, the simulation keeps its own rate
+		PROFILE_END(PROFILE_ZONE_WAIT);
+		PROFILE_BEGIN(PROFILE_ZONE_END_FRAME);
 		vk2dRendererEndFrame();
+		PROFILE_END(PROFILE_ZONE_END_FRAME);
+		PROFILE_END(PROFILE_ZONE_FRAME);
+		PROFILE_FRAME();
 	}
 
 	// Cleanup
@@ -965,7 +996,20 @@ int main() {
 	vk2dModelFree(gGarbageModel);
 	vk2dShaderFree(gShader);
 	vk2dTextureFree(gGarbageDisposalTexture);
-	destroyAssets(gAssets);
+	for (int i = 0; i < GARBAGE_DISPOSAL_FRAMES; i++)
+		vk2dTextureFree(gGarbageDisposalFrames[i]);
+	if (gPack.data != NULL)
+		packDestroyAssets(gAssets);
+	else
+		destroyAssets(gAssets);
+	replayFree(&gReplay);
+	free(gEntityBuffers[0]);
+	free(gEntityBuffers[1]);
+#ifdef LECD_DEBUG_REWIND
+	snapshotFree(&gRewind);
+#endif
+	statsFree();
+	jobsFree();
 	juQuit();
 	vk2dRendererQuit();
 	SDL_DestroyWindow(window);